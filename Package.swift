@@ -15,7 +15,7 @@ let package = Package(
     // --- 🎨 Editors ---
     .library(
       name: "CosmoEditor",
-      targets: ["CodeView", "CosmoEditor"]
+      targets: ["CodeViewCore", "CodeView", "CosmoEditor"]
     ),
     .library(
       name: "CodeLanguages",
@@ -69,7 +69,9 @@ let package = Package(
         .process("Resources")
       ],
       swiftSettings: [
-        .interoperabilityMode(.Cxx)
+        .interoperabilityMode(.Cxx),
+        // compiles the Sdf/Usd code paths not yet built against SwiftUSD.
+        // .define("KRAKEN_EXPERIMENTAL_USD"),
       ]
     ),
     // --- 🎨 Editors ---
@@ -85,11 +87,16 @@ let package = Package(
     .target(
       name: "CodeView",
       dependencies: [
+        .target(name: "CodeViewCore"),
         .product(name: "TextStory", package: "TextStory"),
         .product(name: "Collections", package: "swift-collections"),
       ],
       path: "Sources/Editors/Code/CodeView"
     ),
+    .target(
+      name: "CodeViewCore",
+      path: "Sources/Editors/Code/CodeViewCore"
+    ),
     .target(
       name: "LanguagesBundle",
       path: "Sources/Editors/Code/LanguagesBundle",
@@ -130,11 +137,33 @@ let package = Package(
     .testTarget(
       name: "CodeEditorTests",
       dependencies: [
-        .target(name: "CosmoEditor"),
+        .target(name: "CosmoEditor", condition: .when(platforms: [.macOS])),
+        .target(name: "CodeViewCore"),
         .target(name: "CodeLanguages"),
       ],
       path: "Tests/Editors/Code"
     ),
+    .testTarget(
+      name: "CodeBenchmarks",
+      dependencies: [
+        .target(name: "CosmoEditor", condition: .when(platforms: [.macOS])),
+        .target(name: "CodeViewCore"),
+        .target(name: "CodeLanguages"),
+        .product(name: "SwiftTreeSitter", package: "SwiftTreeSitter"),
+      ],
+      path: "Tests/Editors/CodeBenchmarks",
+      exclude: ["Baselines"]
+    ),
+    .testTarget(
+      name: "KrakenLibTests",
+      dependencies: [
+        .target(name: "KrakenLib"),
+      ],
+      path: "Tests/KrakenLib",
+      swiftSettings: [
+        .interoperabilityMode(.Cxx)
+      ]
+    ),
   ],
   cxxLanguageStandard: .cxx17
 )
@@ -36,32 +36,63 @@ public extension CodeView
   ///   - ranges: The ranges to replace
   ///   - string: The string to insert in the ranges.
   func replaceCharacters(in ranges: [NSRange], with string: String)
+  {
+    replaceCharacters(ranges.map { TextMutation(string: string, range: $0, limit: textStorage.length) })
+  }
+
+  /// Apply a batch of disjoint edits in a single pass.
+  ///
+  /// Every mutation's range is relative to the text *before* any of the batch is applied. Edits are applied back to
+  /// front so each range stays valid, updating the line storage in `O(log n)` per edit. Selections are updated
+  /// once for the whole batch and the undo manager records the batch as one group. The delegate is told the range
+  /// covering the whole batch before any of it is applied, and the text storage is only processed once the batch
+  /// ends, so highlight providers receive a single combined edit and invalidate once.
+  /// - Parameter mutations: The edits to apply. Ranges must not overlap.
+  func replaceCharacters(_ mutations: [TextMutation])
   {
     guard isEditable else { return }
     NotificationCenter.default.post(name: Self.textWillChangeNotification, object: self)
+
+    // Can't insert an empty string into an empty range. One must be not empty
+    let mutations = mutations.sorted(by: { $0.range.location > $1.range.location }).filter
+    {
+      (!$0.range.isEmpty || !$0.string.isEmpty) &&
+        (delegate?.textView(self, shouldReplaceContentsIn: $0.range, with: $0.string) ?? true)
+    }
+    if let first = mutations.first, let last = mutations.last
+    {
+      delegate?.textView(self, willReplaceContentsCovering: NSUnionRange(first.range, last.range))
+    }
+
     layoutManager.beginTransaction()
     textStorage.beginEditing()
 
-    // Can't insert an empty string into an empty range. One must be not empty
-    for range in ranges.sorted(by: { $0.location > $1.location }) where
-      (!range.isEmpty || !string.isEmpty) &&
-      (delegate?.textView(self, shouldReplaceContentsIn: range, with: string) ?? true)
+    var edits: [(range: NSRange, replacementLength: Int)] = []
+    var undoMutations: [(mutation: TextMutation, inverse: TextMutation)] = []
+    edits.reserveCapacity(mutations.count)
+    undoMutations.reserveCapacity(mutations.count)
+
+    for mutation in mutations
     {
+      let range = mutation.range
+      let string = mutation.string
       delegate?.textView(self, willReplaceContentsIn: range, with: string)
 
       layoutManager.willReplaceCharactersInRange(range: range, with: string)
-      _undoManager?.registerMutation(
-        TextMutation(string: string as String, range: range, limit: textStorage.length)
-      )
+      let applied = TextMutation(string: string, range: range, limit: textStorage.length)
+      undoMutations.append((applied, textStorage.inverseMutation(for: applied)))
       textStorage.replaceCharacters(
         in: range,
         with: NSAttributedString(string: string, attributes: typingAttributes)
       )
-      selectionManager.didReplaceCharacters(in: range, replacementLength: (string as NSString).length)
+      edits.append((range, (string as NSString).length))
 
       delegate?.textView(self, didReplaceContentsIn: range, with: string)
     }
 
+    _undoManager?.registerMutations(undoMutations)
+    selectionManager.didReplaceCharacters(in: edits)
+
     layoutManager.endTransaction()
     textStorage.endEditing()
     selectionManager.notifyAfterEdit()
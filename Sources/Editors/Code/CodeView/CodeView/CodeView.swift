@@ -25,6 +25,7 @@
  * -------------------------------------------------------------- */
 
 import AppKit
+import CodeViewCore
 import TextStory
 
 // Disabling file length and type body length as the methods and variables contained in this file cannot be moved
@@ -98,6 +99,7 @@ public class CodeView: NSView, NSTextContent
     {
       setNeedsDisplay()
       layoutManager?.setNeedsLayout()
+      layoutManager?.invalidateMeasuredHeights()
     }
   }
 
@@ -269,6 +271,8 @@ public class CodeView: NSView, NSTextContent
   public private(set) var layoutManager: TextLayoutManager!
   /// The selection manager for the text view.
   public private(set) var selectionManager: TextSelectionManager!
+  /// The search manager for the text view.
+  public private(set) var searchManager: TextSearchManager!
 
   // MARK: - Private Properties
 
@@ -347,6 +351,8 @@ public class CodeView: NSView, NSTextContent
     storageDelegate.addDelegate(layoutManager)
     selectionManager = setUpSelectionManager()
     selectionManager.useSystemCursor = useSystemCursor
+    searchManager = TextSearchManager(textView: self)
+    storageDelegate.addDelegate(searchManager)
 
     _undoManager = CEUndoManager(textView: self)
 
@@ -381,6 +387,7 @@ public class CodeView: NSView, NSTextContent
     selectionManager.setSelectedRanges(selectionManager.textSelections.map(\.range))
 
     _undoManager?.clearStack()
+    searchManager.refresh()
 
     textStorage.delegate = storageDelegate
     needsDisplay = true
@@ -482,9 +489,16 @@ public class CodeView: NSView, NSTextContent
     setUpScrollListeners(scrollView: scrollView)
   }
 
+  override public func viewWillStartLiveResize()
+  {
+    super.viewWillStartLiveResize()
+    layoutManager.beginLiveResize()
+  }
+
   override public func viewDidEndLiveResize()
   {
     super.viewDidEndLiveResize()
+    layoutManager.endLiveResize()
     updateFrameIfNeeded()
   }
 
@@ -28,6 +28,9 @@ import Foundation
 
 public protocol CodeViewDelegate: AnyObject
 {
+  /// Called once before a batch of edits is applied, with the range covering every edit in the batch, in the
+  /// coordinates of the text before the batch.
+  func textView(_ textView: CodeView, willReplaceContentsCovering range: NSRange)
   func textView(_ textView: CodeView, willReplaceContentsIn range: NSRange, with string: String)
   func textView(_ textView: CodeView, didReplaceContentsIn range: NSRange, with string: String)
   func textView(_ textView: CodeView, shouldReplaceContentsIn range: NSRange, with string: String) -> Bool
@@ -35,6 +38,7 @@ public protocol CodeViewDelegate: AnyObject
 
 public extension CodeViewDelegate
 {
+  func textView(_: CodeView, willReplaceContentsCovering _: NSRange) {}
   func textView(_: CodeView, willReplaceContentsIn _: NSRange, with _: String) {}
   func textView(_: CodeView, didReplaceContentsIn _: NSRange, with _: String) {}
   func textView(_: CodeView, shouldReplaceContentsIn _: NSRange, with _: String) -> Bool { true }
@@ -0,0 +1,112 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import AppKit
+import CodeViewCore
+
+/// Measures exact wrapped line heights on a background queue, so scroll geometry settles without every line having
+/// to be laid out first.
+///
+/// The layout manager copies the attributed text of a batch of lines on the main thread and hands it to
+/// ``measure(_:displayData:breakStrategy:cache:completion:)``. Typesetting an immutable attributed string doesn't touch
+/// any shared state, so heights are computed off the main thread and handed back on it to be committed to the line
+/// storage. See ``TextLayoutManager/invalidateMeasuredHeights()``.
+final class LineHeightMeasurer
+{
+  /// A line to measure.
+  struct Line
+  {
+    let id: TextLine.ID
+    /// The index of the line when it was copied.
+    let index: Int
+    /// A copy of the line's attributed text.
+    let string: NSAttributedString
+  }
+
+  /// Incremented to discard results that are still being measured, eg: after an edit shifts line indices.
+  var generation: Int = 0
+  /// Incremented when every measured height goes stale, eg: after the font changes. Lines remember the epoch they
+  /// were measured in with ``TextLine/measuredEpoch``.
+  var epoch: Int = 0
+  /// The layout width the current epoch's heights are measured at.
+  var maxWidth: CGFloat?
+  /// The index of the next line to check for measurement.
+  var nextIndex: Int = 0
+  /// True while a batch is being measured.
+  var isMeasuring: Bool = false
+
+  private let queue = DispatchQueue(label: "foundation.wabi.CodeView.LineHeightMeasurer", qos: .utility)
+
+  /// Measures a batch of lines in the background.
+  /// - Parameters:
+  ///   - lines: The lines to measure.
+  ///   - displayData: The display data to typeset the lines with.
+  ///   - breakStrategy: The strategy used to wrap the lines.
+  ///   - cache: The cache to reuse typeset lines from and add measured lines to, so lines measured in the background
+  ///            don't need to be typeset again when scrolled into view.
+  ///   - completion: Called on the main thread with each line's height, in the same order as `lines`.
+  func measure(
+    _ lines: [Line],
+    displayData: TextLine.DisplayData,
+    breakStrategy: LineBreakStrategy,
+    cache: TypesetCache,
+    completion: @escaping ([CGFloat]) -> Void
+  )
+  {
+    isMeasuring = true
+    queue.async
+    {
+      let heights = lines.map
+      {
+        Self.height(of: $0.string, displayData: displayData, breakStrategy: breakStrategy, cache: cache)
+      }
+      DispatchQueue.main.async
+      {
+        completion(heights)
+      }
+    }
+  }
+
+  /// The height a line will have once it's laid out, matching `TextLayoutManager.layoutLine`.
+  static func height(
+    of string: NSAttributedString,
+    displayData: TextLine.DisplayData,
+    breakStrategy: LineBreakStrategy,
+    cache: TypesetCache? = nil
+  ) -> CGFloat
+  {
+    guard string.length > 0 else { return displayData.estimatedLineHeight }
+    let typesetter = Typesetter()
+    typesetter.typeset(
+      string,
+      displayData: displayData,
+      breakStrategy: breakStrategy,
+      markedRanges: nil,
+      cache: cache
+    )
+    return typesetter.lineFragments.height
+  }
+}
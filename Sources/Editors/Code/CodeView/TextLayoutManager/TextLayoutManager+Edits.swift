@@ -25,6 +25,7 @@
  * -------------------------------------------------------------- */
 
 import AppKit
+import CodeViewCore
 
 // MARK: - Edits
 
@@ -40,6 +41,17 @@ extension TextLayoutManager: NSTextStorageDelegate
   ///   - string: The string to replace in the given range.
   public func willReplaceCharactersInRange(range: NSRange, with string: String)
   {
+    // Lines after the edit shift index, so results being measured are discarded. Only the earliest edit matters,
+    // so the pass restarts once per transaction rather than once per edit.
+    if wrapLines
+    {
+      heightMeasurementEditOffset = min(heightMeasurementEditOffset ?? range.location, range.location)
+      if !isInTransaction
+      {
+        restartHeightMeasurementAfterEdits()
+      }
+    }
+
     // Loop through each line being replaced in reverse, updating and removing where necessary.
     for linePosition in lineStorage.linesInRange(range).reversed()
     {
@@ -0,0 +1,205 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import AppKit
+import CodeViewCore
+
+// MARK: - Height Measurement
+
+/// With ``TextLayoutManager/wrapLines`` enabled, lines start out at the estimated line height and only find their
+/// real height once laid out, which makes the document height and scroller jump while scrolling. These methods keep a
+/// background pass running over every line that hasn't been laid out, committing exact heights in batches.
+public extension TextLayoutManager
+{
+  /// Discards every measured height and measures all lines again.
+  ///
+  /// Call this when something changes the height of every line, like the font or line height multiplier. Changes to
+  /// the layout width are picked up automatically.
+  func invalidateMeasuredHeights()
+  {
+    heightMeasurer.epoch += 1
+    restartHeightMeasurement(from: 0)
+  }
+}
+
+extension TextLayoutManager
+{
+  /// The most lines measured in one background batch.
+  static let heightMeasurementBatchSize = 256
+  /// The most lines checked on the main thread while looking for lines to measure, before yielding.
+  static let heightMeasurementScanLimit = 16384
+
+  /// Discards results being measured and continues the pass from a line, once edits have settled.
+  /// - Parameter index: The first line that may need measuring.
+  func restartHeightMeasurement(from index: Int)
+  {
+    heightMeasurer.generation += 1
+    heightMeasurer.isMeasuring = false
+    heightMeasurer.nextIndex = min(heightMeasurer.nextIndex, index)
+    scheduleHeightMeasurement(after: 0.25)
+  }
+
+  /// Restarts the pass from the earliest line edited since it was last restarted.
+  func restartHeightMeasurementAfterEdits()
+  {
+    guard let offset = heightMeasurementEditOffset else { return }
+    heightMeasurementEditOffset = nil
+    let line = lineStorage.getLine(atOffset: min(offset, max(lineStorage.length - 1, 0)))
+    restartHeightMeasurement(from: line?.index ?? 0)
+  }
+
+  /// Measures the next batch after a delay, coalescing bursts of edits or resizes into a single restart.
+  private func scheduleHeightMeasurement(after delay: TimeInterval)
+  {
+    let generation = heightMeasurer.generation
+    DispatchQueue.main.asyncAfter(deadline: .now() + delay)
+    { [weak self] in
+      guard let self, generation == heightMeasurer.generation else { return }
+      measureNextHeightBatch()
+    }
+  }
+
+  private func measureNextHeightBatch()
+  {
+    let maxWidth = maxLineLayoutWidth
+    // Offscreen lines are measured once a live resize ends, at the final width.
+    guard wrapLines,
+          !isInLiveResize,
+          !heightMeasurer.isMeasuring,
+          delegate != nil,
+          maxWidth > 0,
+          maxWidth < .greatestFiniteMagnitude,
+          let textStorage
+    else
+    {
+      return
+    }
+    if heightMeasurer.maxWidth != maxWidth
+    {
+      heightMeasurer.maxWidth = maxWidth
+      heightMeasurer.epoch += 1
+      heightMeasurer.nextIndex = 0
+    }
+
+    // Collect lines that haven't been measured or laid out at this width, copying their text while on the main thread.
+    let epoch = heightMeasurer.epoch
+    var lines: [LineHeightMeasurer.Line] = []
+    var index = heightMeasurer.nextIndex
+    if let start = lineStorage.getLine(atIndex: index)
+    {
+      let remaining = NSRange(location: start.range.location, length: lineStorage.length - start.range.location)
+      for position in lineStorage.linesInRange(remaining)
+      {
+        guard lines.count < Self.heightMeasurementBatchSize,
+              position.index - heightMeasurer.nextIndex < Self.heightMeasurementScanLimit
+        else
+        {
+          break
+        }
+        index = position.index + 1
+        let line = position.data
+        guard line.measuredEpoch != epoch, line.needsLayout(maxWidth: maxWidth) else { continue }
+        lines.append(LineHeightMeasurer.Line(
+          id: line.id,
+          index: position.index,
+          string: textStorage.attributedSubstring(from: position.range)
+        ))
+      }
+    }
+    heightMeasurer.nextIndex = index
+
+    guard !lines.isEmpty
+    else
+    {
+      if index < lineStorage.count
+      {
+        scheduleHeightMeasurement(after: 0)
+      }
+      return
+    }
+
+    let generation = heightMeasurer.generation
+    let displayData = TextLine.DisplayData(
+      maxWidth: maxWidth,
+      lineHeightMultiplier: lineHeightMultiplier,
+      estimatedLineHeight: estimateLineHeight()
+    )
+    heightMeasurer.measure(
+      lines,
+      displayData: displayData,
+      breakStrategy: lineBreakStrategy,
+      cache: typesetCache
+    )
+    { [weak self] heights in
+      guard let self, generation == heightMeasurer.generation else { return }
+      heightMeasurer.isMeasuring = false
+      commitMeasuredHeights(heights, for: lines, epoch: epoch, maxWidth: maxWidth)
+      scheduleHeightMeasurement(after: 0)
+    }
+  }
+
+  /// Applies a batch of measured heights to the line storage, notifying the delegate once for the whole batch.
+  private func commitMeasuredHeights(
+    _ heights: [CGFloat],
+    for lines: [LineHeightMeasurer.Line],
+    epoch: Int,
+    maxWidth: CGFloat
+  )
+  {
+    let originalHeight = lineStorage.height
+    let visibleMinY = delegate?.visibleRect.minY ?? 0
+    var yContentAdjustment: CGFloat = 0
+
+    for (line, height) in zip(lines, heights)
+    {
+      // Lines laid out while the batch was measured already have their real height.
+      guard let position = lineStorage.getLine(atIndex: line.index),
+            position.data.id == line.id,
+            position.data.needsLayout(maxWidth: maxWidth)
+      else
+      {
+        continue
+      }
+      position.data.measuredEpoch = epoch
+      guard height != position.height else { continue }
+      lineStorage.update(atIndex: position.range.location, delta: 0, deltaHeight: height - position.height)
+      if position.yPos < visibleMinY
+      {
+        // Keep the visible text in place as lines above it change height.
+        yContentAdjustment += height - position.height
+      }
+    }
+
+    if originalHeight != lineStorage.height
+    {
+      delegate?.layoutManagerHeightDidUpdate(newHeight: lineStorage.height)
+    }
+    if yContentAdjustment != 0
+    {
+      delegate?.layoutManagerYAdjustment(yContentAdjustment)
+    }
+  }
+}
@@ -0,0 +1,61 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import AppKit
+import CodeViewCore
+
+// MARK: - Live Resize
+
+/// Changing the layout width invalidates the wrapping of every line, so a live resize would typeset every visible
+/// line on every frame. While resizing, lines wrap at the layout width rounded down to a multiple of
+/// ``TextLayoutManager/liveResizeWidthBucket``. Frames within a bucket keep their layout, and dragging back to a
+/// bucket finds its lines in the typeset cache. Offscreen lines are left at their last height until the resize ends,
+/// when visible lines are wrapped at the exact width and the background height pass measures the rest.
+public extension TextLayoutManager
+{
+  /// The granularity of layout widths during a live resize.
+  static let liveResizeWidthBucket: CGFloat = 16
+
+  /// Starts wrapping lines at bucketed widths, call when the view starts a live resize.
+  func beginLiveResize()
+  {
+    isInLiveResize = true
+  }
+
+  /// Wraps visible lines at the exact layout width again and restarts measuring offscreen lines, call when the view
+  /// ends a live resize.
+  func endLiveResize()
+  {
+    guard isInLiveResize else { return }
+    isInLiveResize = false
+    layoutLines()
+    // Batches discarded during the resize are measured again, lines already measured at this width are skipped.
+    if wrapLines
+    {
+      restartHeightMeasurement(from: 0)
+    }
+  }
+}
@@ -25,6 +25,7 @@
  * -------------------------------------------------------------- */
 
 import AppKit
+import CodeViewCore
 
 public extension TextLayoutManager
 {
@@ -65,6 +66,13 @@ public extension TextLayoutManager
     return lineStorage.getLine(atIndex: index)
   }
 
+  /// Creates an immutable copy of the current lines that can be queried from any thread.
+  /// - Complexity: `O(1)`
+  func lineStorageSnapshot() -> TextLineStorage<TextLine>.Snapshot
+  {
+    lineStorage.snapshot()
+  }
+
   func textOffsetAtPoint(_ point: CGPoint) -> Int?
   {
     guard point.y <= estimatedHeight()
@@ -261,7 +269,8 @@ public extension TextLayoutManager
       range: position.range,
       stringRef: textStorage,
       markedRanges: markedTextManager.markedRanges(in: position.range),
-      breakStrategy: lineBreakStrategy
+      breakStrategy: lineBreakStrategy,
+      cache: typesetCache
     )
     var height: CGFloat = 0
     for fragmentPosition in position.data.lineFragments
@@ -48,6 +48,7 @@ public extension TextLayoutManager
     transactionCounter -= 1
     if transactionCounter == 0
     {
+      restartHeightMeasurementAfterEdits()
       if forceLayout
       {
         setNeedsLayout()
@@ -25,6 +25,7 @@
  * -------------------------------------------------------------- */
 
 import AppKit
+import CodeViewCore
 import Foundation
 
 public protocol TextLayoutManagerDelegate: AnyObject
@@ -49,6 +50,7 @@ public class TextLayoutManager: NSObject
     didSet
     {
       setNeedsLayout()
+      invalidateMeasuredHeights()
     }
   }
 
@@ -57,6 +59,7 @@ public class TextLayoutManager: NSObject
     didSet
     {
       setNeedsLayout()
+      invalidateMeasuredHeights()
     }
   }
 
@@ -83,6 +86,7 @@ public class TextLayoutManager: NSObject
     didSet
     {
       setNeedsLayout()
+      invalidateMeasuredHeights()
     }
   }
 
@@ -104,6 +108,13 @@ public class TextLayoutManager: NSObject
   weak var textStorage: NSTextStorage?
   var lineStorage: TextLineStorage<TextLine> = TextLineStorage()
   var markedTextManager: MarkedTextManager = .init()
+  /// Measures wrapped line heights in the background, see ``TextLayoutManager/invalidateMeasuredHeights()``.
+  let heightMeasurer = LineHeightMeasurer()
+  /// The earliest offset edited since height measurement was last restarted, see
+  /// ``restartHeightMeasurementAfterEdits()``.
+  var heightMeasurementEditOffset: Int?
+  /// Typeset lines reused when an invalidated line's content and display data haven't changed.
+  let typesetCache = TypesetCache()
   private let viewReuseQueue: ViewReuseQueue<LineFragmentView, UUID> = ViewReuseQueue()
   package var visibleLineIds: Set<TextLine.ID> = []
   /// Used to force a complete re-layout using `setNeedsLayout`
@@ -115,6 +126,9 @@ public class TextLayoutManager: NSObject
     transactionCounter > 0
   }
 
+  /// True between ``beginLiveResize()`` and ``endLiveResize()``.
+  public internal(set) var isInLiveResize: Bool = false
+
   weak var layoutView: NSView?
 
   /// The calculated maximum width of all laid out lines.
@@ -129,10 +143,16 @@ public class TextLayoutManager: NSObject
   }
 
   /// The maximum width available to lay out lines in.
+  ///
+  /// During a live resize this is rounded down to a multiple of ``liveResizeWidthBucket``, so most frames reuse the
+  /// previous frame's layout. See ``beginLiveResize()``.
   var maxLineLayoutWidth: CGFloat
   {
-    wrapLines ? (delegate?.textViewportSize().width ?? .greatestFiniteMagnitude) - edgeInsets.horizontal
-      : .greatestFiniteMagnitude
+    guard wrapLines else { return .greatestFiniteMagnitude }
+    let width = (delegate?.textViewportSize().width ?? .greatestFiniteMagnitude) - edgeInsets.horizontal
+    guard isInLiveResize, width < .greatestFiniteMagnitude else { return width }
+    let bucket = Self.liveResizeWidthBucket
+    return max((width / bucket).rounded(.down) * bucket, bucket)
   }
 
   /// Contains all data required to perform layout on a text line.
@@ -141,6 +161,8 @@ public class TextLayoutManager: NSObject
     let minY: CGFloat
     let maxY: CGFloat
     let maxWidth: CGFloat
+    /// False if the line's typesetting is still valid, and only its fragment views need to be laid out.
+    let needsTypeset: Bool
   }
 
   // MARK: - Init
@@ -181,8 +203,9 @@ public class TextLayoutManager: NSObject
       let start = mach_absolute_time()
     #endif
 
-    lineStorage.buildFromTextStorage(textStorage, estimatedLineHeight: estimateLineHeight())
-    detectedLineEnding = LineEnding.detectLineEnding(lineStorage: lineStorage, textStorage: textStorage)
+    let lineEndings = lineStorage.buildFromTextStorage(textStorage, estimatedLineHeight: estimateLineHeight())
+    detectedLineEnding = LineEnding.mostCommon(in: lineEndings)
+    invalidateMeasuredHeights()
 
     #if DEBUG
       let end = mach_absolute_time()
@@ -202,6 +225,7 @@ public class TextLayoutManager: NSObject
     viewReuseQueue.usedViews.removeAll()
     maxLineWidth = 0
     markedTextManager.removeAll()
+    typesetCache.removeAll()
     prepareTextLines()
     setNeedsLayout()
   }
@@ -251,40 +275,44 @@ public class TextLayoutManager: NSObject
     let maxY = max(visibleRect.maxY + verticalLayoutPadding, 0)
     let originalHeight = lineStorage.height
     var usedFragmentIDs = Set<UUID>()
-    var forceLayout: Bool = needsLayout
+    let forceLayout: Bool = needsLayout
     var newVisibleLines: Set<TextLine.ID> = []
     var yContentAdjustment: CGFloat = 0
     var maxFoundLineWidth = maxLineWidth
+    // Height changes are applied to the line storage after the pass. Until then, every line after a changed line is
+    // `yOffset` away from the position the storage reports.
+    var heightDeltas: [(offset: Int, deltaHeight: CGFloat)] = []
+    var yOffset: CGFloat = 0
 
     // Layout all lines
-    for linePosition in lineStorage.linesStartingAt(minY, until: maxY)
+    for linePosition in lineStorage.linesStartingAt(minY, until: .greatestFiniteMagnitude)
     {
-      // Updating height in the loop may cause the iterator to be wrong
-      guard linePosition.yPos < maxY else { break }
-      if forceLayout
-        || linePosition.data.needsLayout(maxWidth: maxLineLayoutWidth)
-        || !visibleLineIds.contains(linePosition.data.id)
+      let yPos = linePosition.yPos + yOffset
+      guard yPos < maxY else { break }
+      let needsTypeset = forceLayout || linePosition.data.needsLayout(maxWidth: maxLineLayoutWidth)
+      if needsTypeset || !visibleLineIds.contains(linePosition.data.id)
       {
         let lineSize = layoutLine(
           linePosition,
           textStorage: textStorage,
-          layoutData: LineLayoutData(minY: linePosition.yPos, maxY: maxY, maxWidth: maxLineLayoutWidth),
+          layoutData: LineLayoutData(
+            minY: yPos,
+            maxY: maxY,
+            maxWidth: maxLineLayoutWidth,
+            needsTypeset: needsTypeset
+          ),
           laidOutFragmentIDs: &usedFragmentIDs
         )
         if lineSize.height != linePosition.height
         {
-          lineStorage.update(
-            atIndex: linePosition.range.location,
-            delta: 0,
-            deltaHeight: lineSize.height - linePosition.height
-          )
-          // If we've updated a line's height, force re-layout for the rest of the pass.
-          forceLayout = true
+          let deltaHeight = lineSize.height - linePosition.height
+          heightDeltas.append((linePosition.range.location, deltaHeight))
+          yOffset += deltaHeight
 
           if linePosition.yPos < minY
           {
             // Adjust the scroll position by the difference between the new height and old.
-            yContentAdjustment += lineSize.height - linePosition.height
+            yContentAdjustment += deltaHeight
           }
         }
         if maxFoundLineWidth < lineSize.width
@@ -294,12 +322,22 @@ public class TextLayoutManager: NSObject
       }
       else
       {
+        // The line's layout is still valid, it only needs to move if a line above it changed height.
+        if yOffset != 0
+        {
+          moveFragmentViews(of: linePosition.data, to: yPos)
+        }
         // Make sure the used fragment views aren't dequeued.
         usedFragmentIDs.formUnion(linePosition.data.typesetter.lineFragments.map(\.data.id))
       }
       newVisibleLines.insert(linePosition.data.id)
     }
 
+    for (offset, deltaHeight) in heightDeltas
+    {
+      lineStorage.update(atIndex: offset, delta: 0, deltaHeight: deltaHeight)
+    }
+
     CATransaction.commit()
 
     // Enqueue any lines not used in this layout pass.
@@ -323,6 +361,16 @@ public class TextLayoutManager: NSObject
       delegate?.layoutManagerYAdjustment(yContentAdjustment)
     }
 
+    // A new layout width makes every measured height stale, restart the background pass at the new width.
+    // The width is recorded now rather than once the pass starts, so layout passes while scrolling don't keep
+    // pushing the restart back.
+    if wrapLines, heightMeasurer.maxWidth != maxLineLayoutWidth
+    {
+      heightMeasurer.maxWidth = maxLineLayoutWidth
+      heightMeasurer.epoch += 1
+      restartHeightMeasurement(from: 0)
+    }
+
     needsLayout = false
   }
 
@@ -349,13 +397,17 @@ public class TextLayoutManager: NSObject
     )
 
     let line = position.data
-    line.prepareForDisplay(
-      displayData: lineDisplayData,
-      range: position.range,
-      stringRef: textStorage,
-      markedRanges: markedTextManager.markedRanges(in: position.range),
-      breakStrategy: lineBreakStrategy
-    )
+    if layoutData.needsTypeset
+    {
+      line.prepareForDisplay(
+        displayData: lineDisplayData,
+        range: position.range,
+        stringRef: textStorage,
+        markedRanges: markedTextManager.markedRanges(in: position.range),
+        breakStrategy: lineBreakStrategy,
+        cache: typesetCache
+      )
+    }
 
     if position.range.isEmpty
     {
@@ -396,6 +448,18 @@ public class TextLayoutManager: NSObject
     view.needsDisplay = true
   }
 
+  /// Moves the views of a laid out line's fragments, without typesetting or redrawing them.
+  /// - Parameters:
+  ///   - line: The line to move.
+  ///   - yPos: The new y value of the line.
+  private func moveFragmentViews(of line: TextLine, to yPos: CGFloat)
+  {
+    for lineFragmentPosition in line.typesetter.lineFragments
+    {
+      viewReuseQueue.usedViews[lineFragmentPosition.data.id]?.frame.origin.y = yPos + lineFragmentPosition.yPos
+    }
+  }
+
   deinit
   {
     lineStorage.removeAll()
@@ -31,12 +31,27 @@ import AppKit
 public final class LineFragment: Identifiable, Equatable
 {
   public let id = UUID()
-  public private(set) var ctLine: CTLine
   public let width: CGFloat
   public let height: CGFloat
   public let descent: CGFloat
   public let scaledHeight: CGFloat
 
+  /// The typeset line. Fragments laid out without a typesetter create it the first time it's drawn or measured.
+  public var ctLine: CTLine
+  {
+    if let _ctLine
+    {
+      return _ctLine
+    }
+    let ctLine = makeCTLine!()
+    _ctLine = ctLine
+    makeCTLine = nil
+    return ctLine
+  }
+
+  private var _ctLine: CTLine?
+  private var makeCTLine: (() -> CTLine)?
+
   /// The difference between the real text height and the scaled height
   public var heightDifference: CGFloat
   {
@@ -51,7 +66,23 @@ public final class LineFragment: Identifiable, Equatable
     lineHeightMultiplier: CGFloat
   )
   {
-    self.ctLine = ctLine
+    _ctLine = ctLine
+    self.width = width
+    self.height = height
+    self.descent = descent
+    scaledHeight = height * lineHeightMultiplier
+  }
+
+  /// Creates a fragment whose `CTLine` is created when first used.
+  init(
+    width: CGFloat,
+    height: CGFloat,
+    descent: CGFloat,
+    lineHeightMultiplier: CGFloat,
+    makeCTLine: @escaping () -> CTLine
+  )
+  {
+    self.makeCTLine = makeCTLine
     self.width = width
     self.height = height
     self.descent = descent
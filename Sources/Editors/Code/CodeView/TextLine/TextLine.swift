@@ -25,6 +25,7 @@
  * -------------------------------------------------------------- */
 
 import AppKit
+import CodeViewCore
 import Foundation
 
 /// Represents a displayable line of text.
@@ -33,6 +34,8 @@ public final class TextLine: Identifiable, Equatable
   public let id: UUID = .init()
   private var needsLayout: Bool = true
   var maxWidth: CGFloat?
+  /// The ``LineHeightMeasurer/epoch`` the line's height was last measured in, in the background.
+  var measuredEpoch: Int?
   private(set) var typesetter: Typesetter = .init()
 
   /// The line fragments contained by this text line.
@@ -45,6 +48,7 @@ public final class TextLine: Identifiable, Equatable
   public func setNeedsLayout()
   {
     needsLayout = true
+    measuredEpoch = nil
     typesetter = Typesetter()
   }
 
@@ -64,12 +68,14 @@ public final class TextLine: Identifiable, Equatable
   ///   - stringRef: A reference to the string storage for the document.
   ///   - markedRanges: Any marked ranges in the line.
   ///   - breakStrategy: Determines how line breaks are calculated.
+  ///   - cache: A cache of previously typeset lines to reuse.
   func prepareForDisplay(
     displayData: DisplayData,
     range: NSRange,
     stringRef: NSTextStorage,
     markedRanges: MarkedTextManager.MarkedRanges?,
-    breakStrategy: LineBreakStrategy
+    breakStrategy: LineBreakStrategy,
+    cache: TypesetCache? = nil
   )
   {
     let string = stringRef.attributedSubstring(from: range)
@@ -78,7 +84,8 @@ public final class TextLine: Identifiable, Equatable
       string,
       displayData: displayData,
       breakStrategy: breakStrategy,
-      markedRanges: markedRanges
+      markedRanges: markedRanges,
+      cache: cache
     )
     needsLayout = false
   }
@@ -89,7 +96,7 @@ public final class TextLine: Identifiable, Equatable
   }
 
   /// Contains all required data to perform a typeset and layout operation on a text line.
-  struct DisplayData
+  struct DisplayData: Hashable
   {
     let maxWidth: CGFloat
     let lineHeightMultiplier: CGFloat
@@ -0,0 +1,246 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeViewCore
+import CoreText
+import Foundation
+
+/// A bounded, least recently used cache of typeset lines, keyed by the line's attributed content and display data.
+///
+/// Typesetting a line is the most expensive part of layout, and the same content is typeset again whenever a line is
+/// invalidated: scrolling it back into view, undoing an edit, or re-highlighting it without changing any colors.
+/// Entries are content-addressed, so they never need to be invalidated, and identical lines like `}` share an entry.
+/// Only lines typeset with CoreText are cached: monospaced lines are laid out in a single linear pass, which costs
+/// about as much as hashing the line for its key.
+/// The cache is safe to use from any thread.
+final class TypesetCache
+{
+  /// A typeset line fragment. `CTLine` is immutable, so fragments can be shared by any number of lines.
+  struct Fragment
+  {
+    let ctLine: CTLine
+    let length: Int
+    let width: CGFloat
+    let height: CGFloat
+    let descent: CGFloat
+  }
+
+  struct Key: Hashable
+  {
+    let contentHash: Int
+    let displayData: TextLine.DisplayData
+    let breakStrategy: LineBreakStrategy
+  }
+
+  private struct Entry
+  {
+    let key: Key
+    /// The typeset string, compared on lookup so hash collisions are misses.
+    let string: NSAttributedString
+    let fragments: [Fragment]
+    var previous: Int?
+    var next: Int?
+  }
+
+  /// The most UTF-16 units of typeset text to keep. Each entry costs its length plus one.
+  let costLimit: Int
+
+  private let lock = NSLock()
+  private var slots: [Key: Int] = [:]
+  private var entries: [Entry?] = []
+  private var freeSlots: [Int] = []
+  /// The most recently used entry.
+  private var head: Int?
+  /// The least recently used entry, evicted first.
+  private var tail: Int?
+  private var totalCost: Int = 0
+
+  init(costLimit: Int = 1 << 20)
+  {
+    self.costLimit = costLimit
+  }
+
+  /// The number of cached lines.
+  var count: Int
+  {
+    lock.lock()
+    defer { lock.unlock() }
+    return slots.count
+  }
+
+  /// Creates the key for a line.
+  /// - Complexity: `O(n)` in the length of the string and its attribute runs.
+  static func key(
+    for string: NSAttributedString,
+    displayData: TextLine.DisplayData,
+    breakStrategy: LineBreakStrategy
+  ) -> Key
+  {
+    var hasher = Hasher()
+    let characters = string.string as NSString
+    let length = characters.length
+    hasher.combine(length)
+    withUnsafeTemporaryAllocation(of: unichar.self, capacity: min(max(length, 1), 4096))
+    { buffer in
+      var location = 0
+      while location < length
+      {
+        let range = NSRange(location: location, length: min(buffer.count, length - location))
+        characters.getCharacters(buffer.baseAddress!, range: range)
+        hasher.combine(bytes: UnsafeRawBufferPointer(start: buffer.baseAddress, count: range.length * 2))
+        location = range.max
+      }
+    }
+    string.enumerateAttributes(in: NSRange(location: 0, length: length))
+    { attributes, range, _ in
+      hasher.combine(range.location)
+      hasher.combine(range.length)
+      for (key, value) in attributes.sorted(by: { $0.key.rawValue < $1.key.rawValue })
+      {
+        hasher.combine(key.rawValue)
+        hasher.combine((value as? NSObject)?.hash)
+      }
+    }
+    return Key(contentHash: hasher.finalize(), displayData: displayData, breakStrategy: breakStrategy)
+  }
+
+  /// Finds the fragments of a typeset line, marking it as most recently used.
+  /// - Parameters:
+  ///   - key: The key created for `string`.
+  ///   - string: The line to find.
+  /// - Returns: The line's fragments, or `nil` if it isn't cached.
+  func fragments(for key: Key, string: NSAttributedString) -> [Fragment]?
+  {
+    lock.lock()
+    defer { lock.unlock() }
+    guard let slot = slots[key], let entry = entries[slot], entry.string.isEqual(to: string) else { return nil }
+    moveToHead(slot)
+    return entry.fragments
+  }
+
+  /// Adds a typeset line, evicting the least recently used lines past ``costLimit``.
+  func insert(_ fragments: [Fragment], for key: Key, string: NSAttributedString)
+  {
+    let cost = string.length + 1
+    guard cost <= costLimit else { return }
+    lock.lock()
+    defer { lock.unlock() }
+    if let slot = slots[key]
+    {
+      remove(slot)
+    }
+    let entry = Entry(key: key, string: string, fragments: fragments, previous: nil, next: head)
+    let slot: Int
+    if let freeSlot = freeSlots.popLast()
+    {
+      slot = freeSlot
+      entries[slot] = entry
+    }
+    else
+    {
+      slot = entries.count
+      entries.append(entry)
+    }
+    if let head
+    {
+      entries[head]?.previous = slot
+    }
+    head = slot
+    if tail == nil
+    {
+      tail = slot
+    }
+    slots[key] = slot
+    totalCost += cost
+    while totalCost > costLimit, let tail
+    {
+      remove(tail)
+    }
+  }
+
+  /// Removes every cached line.
+  func removeAll()
+  {
+    lock.lock()
+    defer { lock.unlock() }
+    slots.removeAll()
+    entries.removeAll()
+    freeSlots.removeAll()
+    head = nil
+    tail = nil
+    totalCost = 0
+  }
+
+  // MARK: - List
+
+  private func unlink(_ slot: Int)
+  {
+    guard let entry = entries[slot] else { return }
+    if let previous = entry.previous
+    {
+      entries[previous]?.next = entry.next
+    }
+    else
+    {
+      head = entry.next
+    }
+    if let next = entry.next
+    {
+      entries[next]?.previous = entry.previous
+    }
+    else
+    {
+      tail = entry.previous
+    }
+  }
+
+  private func moveToHead(_ slot: Int)
+  {
+    guard slot != head else { return }
+    unlink(slot)
+    entries[slot]?.previous = nil
+    entries[slot]?.next = head
+    if let head
+    {
+      entries[head]?.previous = slot
+    }
+    head = slot
+    if tail == nil
+    {
+      tail = slot
+    }
+  }
+
+  private func remove(_ slot: Int)
+  {
+    guard let entry = entries[slot] else { return }
+    unlink(slot)
+    slots[entry.key] = nil
+    totalCost -= entry.string.length + 1
+    entries[slot] = nil
+    freeSlots.append(slot)
+  }
+}
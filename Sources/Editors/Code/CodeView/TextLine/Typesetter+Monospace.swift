@@ -0,0 +1,186 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import AppKit
+import CodeViewCore
+import CoreText
+
+extension Typesetter
+{
+  /// Attributes that don't change how a monospaced line is measured.
+  private static let monospaceAttributes: Set<NSAttributedString.Key> = [
+    .font, .kern, .paragraphStyle, .foregroundColor, .backgroundColor,
+  ]
+
+  /// Lays out a line with ``MonospaceLayout`` when it's set in a single fixed pitch font, skipping CoreText's cluster
+  /// breaking and line measurement. Fragments create their `CTLine` only once they're drawn or measured, so lines
+  /// that are only laid out for their height never touch CoreText.
+  /// - Returns: False if the line needs to be typeset with CoreText.
+  func typesetMonospace(
+    _ string: NSAttributedString,
+    displayData: TextLine.DisplayData,
+    breakStrategy: LineBreakStrategy
+  ) -> Bool
+  {
+    let range = NSRange(location: 0, length: string.length)
+    guard range.length > 0,
+          let style = Self.uniformStyle(of: string),
+          style.font.isFixedPitch
+    else
+    {
+      return false
+    }
+
+    let fragments: [MonospaceLayout.Fragment]? = withUnsafeTemporaryAllocation(of: unichar.self, capacity: range.length)
+    { buffer in
+      (string.string as NSString).getCharacters(buffer.baseAddress!, range: range)
+      let characters = UnsafeBufferPointer(buffer)
+      guard let metrics = Self.monospaceMetrics(style: style, characters: characters) else { return nil }
+      return MonospaceLayout.layout(
+        characters,
+        metrics: metrics,
+        maxWidth: displayData.maxWidth,
+        breakStrategy: breakStrategy
+      )
+    }
+    guard let fragments else { return false }
+
+    let font = style.font as CTFont
+    let descent = CTFontGetDescent(font)
+    let height = CTFontGetAscent(font) + descent + CTFontGetLeading(font)
+    let typesetter = DeferredTypesetter(string: string)
+    var location = 0
+    let lines = fragments.map
+    { fragment in
+      let range = CFRangeMake(location, fragment.length)
+      location += fragment.length
+      let lineFragment = LineFragment(
+        width: fragment.width,
+        height: height,
+        descent: descent,
+        lineHeightMultiplier: displayData.lineHeightMultiplier
+      )
+      {
+        CTTypesetterCreateLine(typesetter.typesetter, range)
+      }
+      return TextLineStorage<LineFragment>.BuildItem(
+        data: lineFragment,
+        length: fragment.length,
+        height: lineFragment.scaledHeight
+      )
+    }
+    self.string = string
+    self.typesetter = nil
+    lineFragments.build(from: lines, estimatedLineHeight: lines.last?.height ?? 0)
+    return true
+  }
+
+  private struct MonospaceStyle
+  {
+    let font: NSFont
+    let kern: CGFloat
+    let paragraphStyle: NSParagraphStyle?
+  }
+
+  /// Finds the font, kern and paragraph style of a string, if every run shares them and no run has attributes that
+  /// change measurement, like a baseline offset.
+  private static func uniformStyle(of string: NSAttributedString) -> MonospaceStyle?
+  {
+    var style: MonospaceStyle?
+    var isUniform = true
+    string.enumerateAttributes(in: NSRange(location: 0, length: string.length))
+    { attributes, _, stop in
+      guard let font = attributes[.font] as? NSFont,
+            attributes.keys.allSatisfy(monospaceAttributes.contains)
+      else
+      {
+        isUniform = false
+        stop.pointee = true
+        return
+      }
+      let runStyle = MonospaceStyle(
+        font: font,
+        kern: attributes[.kern] as? CGFloat ?? 0,
+        paragraphStyle: attributes[.paragraphStyle] as? NSParagraphStyle
+      )
+      if let style,
+         style.font != runStyle.font || style.kern != runStyle.kern || style.paragraphStyle != runStyle.paragraphStyle
+      {
+        isUniform = false
+        stop.pointee = true
+      }
+      style = runStyle
+    }
+    return isUniform ? style : nil
+  }
+
+  /// Measures a column of the font, checking the font has glyphs two columns wide for any wide characters, so
+  /// CoreText wouldn't substitute another font.
+  private static func monospaceMetrics(
+    style: MonospaceStyle,
+    characters: UnsafeBufferPointer<unichar>
+  ) -> MonospaceLayout.Metrics?
+  {
+    let font = style.font as CTFont
+    var space: UniChar = 0x20
+    var glyph = CGGlyph()
+    guard CTFontGetGlyphsForCharacters(font, &space, &glyph, 1) else { return nil }
+    let advance = CGFloat(CTFontGetAdvancesForGlyphs(font, .horizontal, &glyph, nil, 1))
+
+    var wideCharacters = characters.filter { $0 > 0x7F && MonospaceLayout.isWide($0) }
+    if !wideCharacters.isEmpty
+    {
+      var glyphs = [CGGlyph](repeating: 0, count: wideCharacters.count)
+      var advances = [CGSize](repeating: .zero, count: wideCharacters.count)
+      guard CTFontGetGlyphsForCharacters(font, &wideCharacters, &glyphs, wideCharacters.count) else { return nil }
+      CTFontGetAdvancesForGlyphs(font, .horizontal, &glyphs, &advances, glyphs.count)
+      guard advances.allSatisfy({ abs($0.width - advance * 2) < 0.01 }) else { return nil }
+    }
+
+    // Tab stops other than the default interval can't be laid out in columns.
+    let tabInterval = if let paragraphStyle = style.paragraphStyle, paragraphStyle.tabStops.isEmpty
+    {
+      paragraphStyle.defaultTabInterval
+    }
+    else
+    {
+      CGFloat(0)
+    }
+    return MonospaceLayout.Metrics(advance: advance + style.kern, tabInterval: tabInterval)
+  }
+}
+
+/// Creates a `CTTypesetter` for a line the first time one of its lazily typeset fragments needs a `CTLine`.
+private final class DeferredTypesetter
+{
+  let string: NSAttributedString
+  private(set) lazy var typesetter: CTTypesetter = CTTypesetterCreateWithAttributedString(string)
+
+  init(string: NSAttributedString)
+  {
+    self.string = string
+  }
+}
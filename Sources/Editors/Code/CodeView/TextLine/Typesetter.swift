@@ -24,6 +24,7 @@
  *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
  * -------------------------------------------------------------- */
 
+import CodeViewCore
 import CoreText
 import Foundation
 
@@ -31,7 +32,11 @@ final class Typesetter
 {
   var typesetter: CTTypesetter?
   var string: NSAttributedString!
+  /// The characters of ``string``, read by line breaking without creating substrings.
+  private var characters: NSString = ""
   var lineFragments = TextLineStorage<LineFragment>()
+  /// Set to false to always typeset with CoreText, even when ``MonospaceLayout`` could lay the line out.
+  var allowsMonospaceLayout = true
 
   // MARK: - Init & Prepare
 
@@ -41,10 +46,34 @@ final class Typesetter
     _ string: NSAttributedString,
     displayData: TextLine.DisplayData,
     breakStrategy: LineBreakStrategy,
-    markedRanges: MarkedTextManager.MarkedRanges?
+    markedRanges: MarkedTextManager.MarkedRanges?,
+    cache: TypesetCache? = nil
   )
   {
     lineFragments.removeAll()
+    // Monospaced layout is cheaper than building a cache key, so the cache only covers the CoreText path below.
+    if allowsMonospaceLayout,
+       markedRanges == nil,
+       typesetMonospace(string, displayData: displayData, breakStrategy: breakStrategy)
+    {
+      return
+    }
+    // Marked text is transient, so lines containing it aren't worth caching.
+    let cacheKey: TypesetCache.Key? = if cache != nil, markedRanges == nil
+    {
+      TypesetCache.key(for: string, displayData: displayData, breakStrategy: breakStrategy)
+    }
+    else
+    {
+      nil
+    }
+    if let cache, let cacheKey, let fragments = cache.fragments(for: cacheKey, string: string)
+    {
+      self.string = string
+      typesetter = nil
+      restore(fragments, lineHeightMultiplier: displayData.lineHeightMultiplier)
+      return
+    }
     if let markedRanges
     {
       let mutableString = NSMutableAttributedString(attributedString: string)
@@ -59,12 +88,49 @@ final class Typesetter
       self.string = string
     }
     typesetter = CTTypesetterCreateWithAttributedString(self.string)
+    characters = self.string.string as NSString
     generateLines(
       maxWidth: displayData.maxWidth,
       lineHeightMultiplier: displayData.lineHeightMultiplier,
       estimatedLineHeight: displayData.estimatedLineHeight,
       breakStrategy: breakStrategy
     )
+    if let cache, let cacheKey
+    {
+      let fragments = lineFragments.map
+      {
+        TypesetCache.Fragment(
+          ctLine: $0.data.ctLine,
+          length: $0.range.length,
+          width: $0.data.width,
+          height: $0.data.height,
+          descent: $0.data.descent
+        )
+      }
+      cache.insert(fragments, for: cacheKey, string: string)
+    }
+  }
+
+  /// Rebuilds line fragments from a cached layout. Fragments get new identities, so lines sharing a cached layout
+  /// never share fragment views.
+  private func restore(_ fragments: [TypesetCache.Fragment], lineHeightMultiplier: CGFloat)
+  {
+    let lines = fragments.map
+    { fragment in
+      let lineFragment = LineFragment(
+        ctLine: fragment.ctLine,
+        width: fragment.width,
+        height: fragment.height,
+        descent: fragment.descent,
+        lineHeightMultiplier: lineHeightMultiplier
+      )
+      return TextLineStorage<LineFragment>.BuildItem(
+        data: lineFragment,
+        length: fragment.length,
+        height: lineFragment.scaledHeight
+      )
+    }
+    lineFragments.build(from: lines, estimatedLineHeight: lines.last?.height ?? 0)
   }
 
   // MARK: - Generate lines
@@ -199,8 +265,7 @@ final class Typesetter
     {
       return breakIndex
     }
-    let substring = string.attributedSubstring(from: NSRange(location: breakIndex - 1, length: 2)).string
-    if substring == LineEnding.carriageReturnLineFeed.rawValue
+    if LineBreakClassifier.isInsideCarriageReturnLineFeed(characters, at: breakIndex)
     {
       // Breaking in the middle of the clrf line ending
       return breakIndex + 1
@@ -260,10 +325,7 @@ final class Typesetter
   /// - Returns: True, if the character is a whitespace or punctuation character.
   private func ensureCharacterCanBreakLine(at index: Int) -> Bool
   {
-    let set = CharacterSet(
-      charactersIn: string.attributedSubstring(from: NSRange(location: index, length: 1)).string
-    )
-    return set.isSubset(of: .whitespacesAndNewlines) || set.isSubset(of: .punctuationCharacters)
+    LineBreakClassifier.canBreakLine(after: characters.character(at: index))
   }
 
   /// Check if the break index is on a CRLF (`\r\n`) character, indicating a valid break position.
@@ -271,15 +333,7 @@ final class Typesetter
   /// - Returns: True, if the break index lies after the `\n` character in a `\r\n` sequence.
   private func checkIfLineBreakOnCRLF(_ breakIndex: Int) -> Bool
   {
-    guard breakIndex - 1 > 0, breakIndex + 1 <= string.length
-    else
-    {
-      return false
-    }
-    let substringRange = NSRange(location: breakIndex - 1, length: 2)
-    let substring = string.attributedSubstring(from: substringRange).string
-
-    return substring == LineEnding.carriageReturnLineFeed.rawValue
+    LineBreakClassifier.isInsideCarriageReturnLineFeed(characters, at: breakIndex)
   }
 
   deinit
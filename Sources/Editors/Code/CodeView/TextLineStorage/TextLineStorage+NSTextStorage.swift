@@ -25,26 +25,24 @@
  * -------------------------------------------------------------- */
 
 import AppKit
+import CodeViewCore
 
 extension TextLineStorage where Data == TextLine
 {
   /// Builds the line storage object from the given `NSTextStorage`.
+  ///
+  /// Lines are found with ``LineBreakScanner``, which also counts the document's line endings along the way.
   /// - Parameters:
   ///   - textStorage: The text storage object to use.
   ///   - estimatedLineHeight: The estimated height of each individual line.
-  func buildFromTextStorage(_ textStorage: NSTextStorage, estimatedLineHeight: CGFloat)
+  /// - Returns: The number of each kind of line ending in the text storage.
+  @discardableResult
+  func buildFromTextStorage(_ textStorage: NSTextStorage, estimatedLineHeight: CGFloat) -> LineBreakScanner.Histogram
   {
-    var index = 0
-    var lines: [BuildItem] = []
-    while let range = textStorage.getNextLine(startingAt: index)
+    let scan = LineBreakScanner.scan(textStorage.mutableString)
+    var lines = scan.lines.map
     {
-      lines.append(BuildItem(data: TextLine(), length: range.max - index, height: estimatedLineHeight))
-      index = NSMaxRange(range)
-    }
-    // Create the last line
-    if textStorage.length - index > 0
-    {
-      lines.append(BuildItem(data: TextLine(), length: textStorage.length - index, height: estimatedLineHeight))
+      BuildItem(data: TextLine(), length: $0.length, height: estimatedLineHeight)
     }
 
     if textStorage.length == 0
@@ -55,5 +53,6 @@ extension TextLineStorage where Data == TextLine
 
     // Use an efficient tree building algorithm rather than adding lines sequentially
     build(from: lines, estimatedLineHeight: estimatedLineHeight)
+    return scan.histogram
   }
 }
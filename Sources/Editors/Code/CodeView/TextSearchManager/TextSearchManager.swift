@@ -0,0 +1,144 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import AppKit
+import CodeViewCore
+import TextStory
+
+/// Searches the text of a ``CodeView``, keeping the matches up to date as the text is edited.
+///
+/// Matches are found in the background by a ``TextSearchEngine``. Every edit to the text storage shifts the matches
+/// after it and searches the lines around it again, so the results stay valid without searching the whole text.
+public final class TextSearchManager: NSObject, NSTextStorageDelegate
+{
+  /// The engine finding and indexing matches.
+  public let engine = TextSearchEngine()
+
+  /// The matches found so far, in document order.
+  public var results: SearchResultIndex
+  {
+    engine.results
+  }
+
+  /// Called on the main thread whenever the results change.
+  public var onUpdate: ((TextSearchManager) -> Void)?
+
+  private weak var textView: CodeView?
+
+  init(textView: CodeView)
+  {
+    self.textView = textView
+    super.init()
+    engine.onUpdate =
+    { [weak self] _ in
+      guard let self else { return }
+      self.onUpdate?(self)
+    }
+  }
+
+  // MARK: - Searching
+
+  /// Starts searching the text for `query`, replacing any previous results.
+  public func find(_ query: TextSearchEngine.Query)
+  {
+    guard let textView else { return }
+    engine.search(query, in: textView.textStorage.mutableString)
+  }
+
+  /// Stops searching and clears the results.
+  public func clear()
+  {
+    engine.clear()
+  }
+
+  /// Searches for the current query again, for when the text has been replaced wholesale.
+  func refresh()
+  {
+    guard let query = engine.query else { return }
+    find(query)
+  }
+
+  // MARK: - Navigation
+
+  /// Selects the first match after the selection, wrapping around to the start of the text.
+  public func selectNextMatch()
+  {
+    guard let textView else { return }
+    let location = textView.selectionManager.textSelections.map { NSMaxRange($0.range) }.max() ?? 0
+    select(engine.results.first(startingAt: location) ?? engine.results.first)
+  }
+
+  /// Selects the last match before the selection, wrapping around to the end of the text.
+  public func selectPreviousMatch()
+  {
+    guard let textView else { return }
+    let location = textView.selectionManager.textSelections.map(\.range.location).min() ?? 0
+    select(engine.results.last(endingAt: location) ?? engine.results.last)
+  }
+
+  private func select(_ match: NSRange?)
+  {
+    guard let textView, let match else { return }
+    textView.selectionManager.setSelectedRange(match)
+    textView.scrollSelectionToVisible()
+  }
+
+  // MARK: - Replacing
+
+  /// Replaces every match of the current query.
+  ///
+  /// Matches are found again against the current text, then replaced in a single pass through
+  /// `CodeView.replaceCharacters(_:)`, which registers them as one undo group.
+  /// - Parameter template: The replacement. For regular expressions, `$0`-style references are expanded.
+  /// - Returns: The number of matches replaced.
+  @discardableResult
+  public func replaceAll(with template: String) -> Int
+  {
+    guard let textView, textView.isEditable, let query = engine.query else { return 0 }
+    let replacements = TextSearchEngine.replacements(of: query, with: template, in: textView.textStorage.mutableString)
+    guard !replacements.isEmpty else { return 0 }
+    let length = textView.textStorage.length
+    textView.replaceCharacters(replacements.map { TextMutation(string: $0.string, range: $0.range, limit: length) })
+    return replacements.count
+  }
+
+  // MARK: - NSTextStorageDelegate
+
+  public func textStorage(
+    _ textStorage: NSTextStorage,
+    didProcessEditing editedMask: NSTextStorageEditActions,
+    range editedRange: NSRange,
+    changeInLength delta: Int
+  )
+  {
+    guard editedMask.contains(.editedCharacters) else { return }
+    engine.textDidChange(
+      in: NSRange(location: editedRange.location, length: editedRange.length - delta),
+      replacementLength: editedRange.length,
+      text: textStorage.mutableString
+    )
+  }
+}
@@ -24,6 +24,7 @@
  *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
  * -------------------------------------------------------------- */
 
+import CodeViewCore
 import Foundation
 
 extension TextSelectionManager
@@ -30,47 +30,49 @@ extension TextSelectionManager
 {
   public func didReplaceCharacters(in range: NSRange, replacementLength: Int)
   {
-    let delta = replacementLength == 0 ? -range.length : replacementLength
-    for textSelection in textSelections
+    didReplaceCharacters(in: [(range, replacementLength)])
+  }
+
+  /// Updates every selection for a batch of edits in a single pass.
+  ///
+  /// Selections touched by an edit collapse to the end of its replacement, selections after an edit are shifted by
+  /// the edit's delta, and every selection is collapsed to a cursor. Both the edits and the selections are walked
+  /// in location order, so the update is `O((n + m) log m)` rather than visiting every selection for every edit.
+  /// - Parameter edits: Disjoint ranges, relative to the text before any of the edits were applied, paired with the
+  ///                    length of the string that replaced them.
+  public func didReplaceCharacters(in edits: [(range: NSRange, replacementLength: Int)])
+  {
+    guard !edits.isEmpty else { return }
+    let edits = edits.sorted { $0.range.location < $1.range.location }
+
+    var editIdx = 0
+    var delta = 0
+    for textSelection in textSelections.sorted(by: { $0.range.location < $1.range.location })
     {
-      if textSelection.range.location > range.max
+      let range = textSelection.range
+      // Accumulate every edit that ends before this selection begins.
+      while editIdx < edits.count, edits[editIdx].range.max < range.location
       {
-        textSelection.range.location = max(0, textSelection.range.location + delta)
-        textSelection.range.length = 0
+        delta += edits[editIdx].replacementLength - edits[editIdx].range.length
+        editIdx += 1
       }
-      else if textSelection.range.intersection(range) != nil
-        || textSelection.range == range
-        || (textSelection.range.isEmpty && textSelection.range.location == range.max)
+
+      if editIdx < edits.count,
+         edits[editIdx].range.location <= range.location || edits[editIdx].range.location < range.max
       {
-        if replacementLength > 0
-        {
-          textSelection.range.location = range.location + replacementLength
-        }
-        else
-        {
-          textSelection.range.location = range.location
-        }
-        textSelection.range.length = 0
+        let edit = edits[editIdx]
+        textSelection.range.location = max(0, edit.range.location + delta + edit.replacementLength)
       }
       else
       {
-        textSelection.range.length = 0
+        textSelection.range.location = max(0, range.location + delta)
       }
+      textSelection.range.length = 0
     }
 
-    // Clean up duplicate selection ranges
+    // Clean up duplicate selection ranges, keeping the last of each in one pass.
     var allRanges: Set<NSRange> = []
-    for (idx, selection) in textSelections.enumerated().reversed()
-    {
-      if allRanges.contains(selection.range)
-      {
-        textSelections.remove(at: idx)
-      }
-      else
-      {
-        allRanges.insert(selection.range)
-      }
-    }
+    textSelections = Array(textSelections.reversed().filter { allRanges.insert($0.range).inserted }.reversed())
   }
 
   func notifyAfterEdit()
@@ -74,14 +74,67 @@ public class CEUndoManager
   /// Represents a group of mutations that should be treated as one mutation when undoing/redoing.
   private struct UndoGroup
   {
-    var mutations: [Mutation]
+    private(set) var mutations: [Mutation]
+    /// The bytes of text the group holds in memory.
+    private(set) var cost: Int
+    /// True once the group's text has been written to the spill file.
+    private(set) var isSpilled: Bool = false
+
+    init(mutations: [Mutation])
+    {
+      self.mutations = mutations
+      cost = mutations.reduce(0) { $0 + $1.cost }
+    }
+
+    mutating func append(contentsOf newMutations: [Mutation])
+    {
+      mutations.append(contentsOf: newMutations)
+      cost += newMutations.reduce(0) { $0 + $1.cost }
+    }
+
+    /// Moves the group's text to the spill file.
+    /// - Returns: The change in the group's cost.
+    mutating func spill(to store: UndoHistoryStore) -> Int
+    {
+      let oldCost = cost
+      for idx in mutations.indices
+      {
+        mutations[idx].inserted = store.spill(mutations[idx].inserted)
+        mutations[idx].deleted = store.spill(mutations[idx].deleted)
+      }
+      cost = mutations.reduce(0) { $0 + $1.cost }
+      isSpilled = true
+      return cost - oldCost
+    }
   }
 
-  /// A single undo mutation.
+  /// A single undo mutation, replacing the text in `range` with `inserted`. The inverse replaces the inserted text
+  /// with `deleted`, so only the two strings are kept.
   private struct Mutation
   {
-    var mutation: TextMutation
-    var inverse: TextMutation
+    let range: NSRange
+    var inserted: UndoText
+    var deleted: UndoText
+
+    /// The range of the inserted text, once the mutation has been applied.
+    var insertedRange: NSRange
+    {
+      NSRange(location: range.location, length: inserted.utf16Length)
+    }
+
+    var cost: Int
+    {
+      inserted.cost + deleted.cost
+    }
+  }
+
+  /// A replacement applied by an undo or redo.
+  struct Edit
+  {
+    var range: NSRange
+    var string: String
+    /// The length of `string` in UTF-16 code units.
+    var length: Int
   }
 
   public let manager: DelegatedUndoManager
@@ -99,14 +152,35 @@ public class CEUndoManager
   }
 
   /// A stack of operations that can be undone.
-  private var undoStack: [UndoGroup] = []
+  private(set) var undoStack: [UndoGroup] = []
   /// A stack of operations that can be redone.
   private var redoStack: [UndoGroup] = []
 
+  /// The most bytes of undo text to keep in memory. Past this, the text of the oldest undo groups is spilled to a
+  /// temporary file and read back when they're undone. Defaults to 32MB.
+  public var memoryLimit: Int = 32 << 20
+  {
+    didSet
+    {
+      enforceMemoryLimit()
+    }
+  }
+
+  /// The bytes of undo text currently held in memory.
+  public private(set) var memoryUsage: Int = 0
+
+  private let store = UndoHistoryStore()
+
+  /// A journal recording every edit made to the text view, including undos and redos, so unsaved changes can be
+  /// recovered after a crash.
+  public var journal: EditJournal?
+
   private weak var textView: CodeView?
   public private(set) var isGrouping: Bool = false
   /// True when the manager is ignoring mutations.
   private var isDisabled: Bool = false
+  /// True when the next registered mutation starts a new group, see ``registerSeparately(_:)``.
+  private var startsNewGroup: Bool = false
 
   // MARK: - Init
 
@@ -127,19 +201,27 @@ public class CEUndoManager
   /// Performs an undo operation if there is one available.
   public func undo()
   {
-    guard !isDisabled, let item = undoStack.popLast(), let textView
+    guard !isDisabled, let textView, let item = undoStack.popLast()
     else
     {
       return
     }
-    isUndoing = true
-    NotificationCenter.default.post(name: .NSUndoManagerWillUndoChange, object: manager)
-    textView.textStorage.beginEditing()
-    for mutation in item.mutations.reversed()
+    guard let strings = load(item.mutations.map(\.deleted))
+    else
     {
-      textView.replaceCharacters(in: mutation.inverse.range, with: mutation.inverse.string)
+      // The history can't be trusted past a group that can't be read back.
+      clearStack()
+      return
     }
-    textView.textStorage.endEditing()
+    isUndoing = true
+    NotificationCenter.default.post(name: .NSUndoManagerWillUndoChange, object: manager)
+    apply(
+      zip(item.mutations, strings).reversed().map
+      { mutation, string in
+        Edit(range: mutation.insertedRange, string: string, length: mutation.range.length)
+      },
+      to: textView
+    )
     NotificationCenter.default.post(name: .NSUndoManagerDidUndoChange, object: manager)
     redoStack.append(item)
     isUndoing = false
@@ -148,39 +230,123 @@ public class CEUndoManager
   /// Performs a redo operation if there is one available.
   public func redo()
   {
-    guard !isDisabled, let item = redoStack.popLast(), let textView
+    guard !isDisabled, let textView, let item = redoStack.popLast()
     else
     {
       return
     }
-    isRedoing = true
-    NotificationCenter.default.post(name: .NSUndoManagerWillRedoChange, object: manager)
-    textView.textStorage.beginEditing()
-    for mutation in item.mutations
+    guard let strings = load(item.mutations.map(\.inserted))
+    else
     {
-      textView.replaceCharacters(in: mutation.mutation.range, with: mutation.mutation.string)
+      clearStack()
+      return
     }
-    textView.textStorage.endEditing()
+    isRedoing = true
+    NotificationCenter.default.post(name: .NSUndoManagerWillRedoChange, object: manager)
+    apply(
+      zip(item.mutations, strings).map
+      { mutation, string in
+        Edit(range: mutation.range, string: string, length: mutation.inserted.utf16Length)
+      },
+      to: textView
+    )
     NotificationCenter.default.post(name: .NSUndoManagerDidRedoChange, object: manager)
     undoStack.append(item)
     isRedoing = false
   }
 
+  /// Applies the edits of an undo or redo to the text view.
+  ///
+  /// When the edits can be rewritten as one batch they're applied in a single pass, so the layout manager, selections,
+  /// syntax tree and highlighter see one combined edit. Otherwise each edit is applied in turn.
+  private func apply(_ edits: [Edit], to textView: CodeView)
+  {
+    if let batch = Self.batch(edits)
+    {
+      let length = textView.textStorage.length
+      textView.replaceCharacters(batch.map { TextMutation(string: $0.string, range: $0.range, limit: length) })
+    }
+    else
+    {
+      textView.textStorage.beginEditing()
+      for edit in edits
+      {
+        textView.replaceCharacters(in: edit.range, with: edit.string)
+      }
+      textView.textStorage.endEditing()
+    }
+  }
+
+  /// Rewrites a sequence of edits, each relative to the text left by the edit before it, as disjoint edits relative
+  /// to the text before the first one. Edits that touch are merged.
+  ///
+  /// Only sequences ordered by location are rewritten, which covers typing, deleting, multi-cursor edits and
+  /// replace-all, and lets the rewrite run in linear time.
+  /// - Returns: The edits in document order, or `nil` if the sequence isn't ordered by location.
+  static func batch(_ edits: [Edit]) -> [Edit]?
+  {
+    guard edits.count > 1 else { return edits }
+    var result: [Edit] = []
+    result.reserveCapacity(edits.count)
+    if zip(edits, edits.dropFirst()).allSatisfy({ $1.range.max <= $0.range.location })
+    {
+      // Each edit comes before the last one, so none of them moves the others.
+      for edit in edits.reversed()
+      {
+        merge(edit, into: &result)
+      }
+    }
+    else if zip(edits, edits.dropFirst()).allSatisfy({ $1.range.location >= $0.range.location + $0.length })
+    {
+      // Each edit comes after the text inserted by the last one, so it's moved by the edits before it.
+      var delta = 0
+      for var edit in edits
+      {
+        edit.range.location -= delta
+        delta += edit.length - edit.range.length
+        merge(edit, into: &result)
+      }
+    }
+    else
+    {
+      return nil
+    }
+    return result
+  }
+
+  private static func merge(_ edit: Edit, into edits: inout [Edit])
+  {
+    guard let last = edits.last, last.range.max == edit.range.location
+    else
+    {
+      edits.append(edit)
+      return
+    }
+    edits[edits.count - 1].range.length += edit.range.length
+    edits[edits.count - 1].string.append(edit.string)
+    edits[edits.count - 1].length += edit.length
+  }
+
   /// Clears the undo/redo stacks.
   public func clearStack()
   {
     undoStack.removeAll()
     redoStack.removeAll()
+    memoryUsage = 0
+    store.removeAll()
   }
 
   // MARK: - Mutations
 
   /// Registers a mutation into the undo stack.
   ///
-  /// Calling this method while the manager is in an undo/redo operation will result in a no-op.
+  /// Must be called before the mutation is applied, as the inverse is read from the text view's current text.
+  /// Calling this method while the manager is in an undo/redo operation will result in a no-op, though the mutation
+  /// is still recorded in the ``journal``.
   /// - Parameter mutation: The mutation to register for undo/redo
   public func registerMutation(_ mutation: TextMutation)
   {
+    journal?.append(replacing: mutation.range, with: mutation.string)
     guard let textView,
           let textStorage = textView.textStorage,
           !isUndoing,
@@ -189,28 +355,137 @@ public class CEUndoManager
     {
       return
     }
-    let newMutation = Mutation(mutation: mutation, inverse: textStorage.inverseMutation(for: mutation))
-    if !undoStack.isEmpty, let lastMutation = undoStack.last?.mutations.last
+    register(makeMutation(mutation, inverse: textStorage.inverseMutation(for: mutation)))
+  }
+
+  /// Registers a batch of mutations applied in one pass as a single undo group.
+  ///
+  /// Used for edits like multi-cursor typing, so one undo reverts every cursor at once. Each inverse must be
+  /// computed against the text storage *before* its mutation was applied.
+  ///
+  /// Calling this method while the manager is in an undo/redo operation will result in a no-op.
+  /// - Parameter mutations: The mutations in the order they were applied, paired with their inverses.
+  public func registerMutations(_ mutations: [(mutation: TextMutation, inverse: TextMutation)])
+  {
+    // Undos and redos are applied through the text view too, so they're journaled here like any other edit.
+    for (mutation, _) in mutations
+    {
+      journal?.append(replacing: mutation.range, with: mutation.string)
+    }
+    guard !mutations.isEmpty, !isUndoing, !isRedoing
+    else
+    {
+      return
+    }
+    guard mutations.count > 1
+    else
+    {
+      register(makeMutation(mutations[0].mutation, inverse: mutations[0].inverse))
+      return
+    }
+    let newMutations = mutations.map { makeMutation($0.mutation, inverse: $0.inverse) }
+    if isGrouping, !startsNewGroup, !undoStack.isEmpty
+    {
+      appendToLastGroup(newMutations)
+    }
+    else
+    {
+      pushGroup(UndoGroup(mutations: newMutations))
+    }
+    startsNewGroup = false
+
+    removeRedoStack()
+  }
+
+  /// Appends a mutation to the current undo group, or starts a new group if it can't be continued.
+  private func register(_ newMutation: Mutation)
+  {
+    if !startsNewGroup, !undoStack.isEmpty, let lastMutation = undoStack.last?.mutations.last
     {
       if isGrouping || shouldContinueGroup(newMutation, lastMutation: lastMutation)
       {
-        undoStack[undoStack.count - 1].mutations.append(newMutation)
+        appendToLastGroup([newMutation])
       }
       else
       {
-        undoStack.append(UndoGroup(mutations: [newMutation]))
+        pushGroup(UndoGroup(mutations: [newMutation]))
       }
     }
     else
     {
-      undoStack.append(
-        UndoGroup(mutations: [newMutation])
-      )
+      pushGroup(UndoGroup(mutations: [newMutation]))
+    }
+    startsNewGroup = false
+
+    removeRedoStack()
+  }
+
+  private func makeMutation(_ mutation: TextMutation, inverse: TextMutation) -> Mutation
+  {
+    Mutation(range: mutation.range, inserted: store.store(mutation.string), deleted: store.store(inverse.string))
+  }
+
+  /// Loads the strings of a group's texts.
+  /// - Returns: The strings, or `nil` if any spilled text couldn't be read back.
+  private func load(_ texts: [UndoText]) -> [String]?
+  {
+    var strings: [String] = []
+    strings.reserveCapacity(texts.count)
+    for text in texts
+    {
+      guard let string = store.string(for: text) else { return nil }
+      strings.append(string)
     }
+    return strings
+  }
 
+  // MARK: - Memory
+
+  private func pushGroup(_ group: UndoGroup)
+  {
+    undoStack.append(group)
+    memoryUsage += group.cost
+    enforceMemoryLimit()
+  }
+
+  private func appendToLastGroup(_ mutations: [Mutation])
+  {
+    let oldCost = undoStack[undoStack.count - 1].cost
+    undoStack[undoStack.count - 1].append(contentsOf: mutations)
+    memoryUsage += undoStack[undoStack.count - 1].cost - oldCost
+    enforceMemoryLimit()
+  }
+
+  private func removeRedoStack()
+  {
+    memoryUsage -= redoStack.reduce(0) { $0 + $1.cost }
     redoStack.removeAll()
   }
 
+  /// Spills the oldest undo groups, then the furthest redo groups, until memory use is back under three quarters of
+  /// ``memoryLimit``. The most recent group stays in memory so typing never waits on disk.
+  private func enforceMemoryLimit()
+  {
+    guard memoryUsage > memoryLimit else { return }
+    let target = memoryLimit / 4 * 3
+    for idx in undoStack.indices.dropLast() where !undoStack[idx].isSpilled
+    {
+      memoryUsage += undoStack[idx].spill(to: store)
+      if memoryUsage <= target
+      {
+        return
+      }
+    }
+    for idx in redoStack.indices where !redoStack[idx].isSpilled
+    {
+      memoryUsage += redoStack[idx].spill(to: store)
+      if memoryUsage <= target
+      {
+        return
+      }
+    }
+  }
+
   // MARK: - Grouping
 
   /// Groups all incoming mutations.
@@ -252,18 +527,18 @@ public class CEUndoManager
   private func shouldContinueGroup(_ mutation: Mutation, lastMutation: Mutation) -> Bool
   {
     // If last mutation was delete & new is insert or vice versa, split group
-    if (mutation.mutation.range.length > 0 && lastMutation.mutation.range.length == 0)
-      || (mutation.mutation.range.length == 0 && lastMutation.mutation.range.length > 0)
+    if (mutation.range.length > 0 && lastMutation.range.length == 0)
+      || (mutation.range.length == 0 && lastMutation.range.length > 0)
     {
       return false
     }
 
-    if mutation.mutation.string.isEmpty
+    if mutation.inserted.isEmpty
     {
       // Deleting
       return
-        lastMutation.mutation.range.location == mutation.mutation.range.max
-          && LineEnding(line: lastMutation.inverse.string) == nil
+        lastMutation.range.location == mutation.range.max
+          && lastMutation.deleted.last.flatMap { LineEnding(line: String($0)) } == nil
     }
     else
     {
@@ -271,17 +546,19 @@ public class CEUndoManager
 
       // Only attempt this check if the mutations are small enough.
       // If the last mutation was not whitespace, and the new one is, break the group.
-      if lastMutation.mutation.string.count < 1024,
-         mutation.mutation.string.count < 1024,
-         !lastMutation.mutation.string.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty,
-         mutation.mutation.string.trimmingCharacters(in: .whitespaces).isEmpty
+      if lastMutation.inserted.utf16Length < 1024,
+         mutation.inserted.utf16Length < 1024,
+         let lastString = lastMutation.inserted.string,
+         let string = mutation.inserted.string,
+         !lastString.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty,
+         string.trimmingCharacters(in: .whitespaces).isEmpty
       {
         return false
       }
 
       return
-        lastMutation.mutation.range.max + 1 == mutation.mutation.range.location
-          && LineEnding(line: mutation.mutation.string) == nil
+        lastMutation.range.max + 1 == mutation.range.location
+          && mutation.inserted.last.flatMap { LineEnding(line: String($0)) } == nil
     }
   }
 
@@ -301,6 +578,19 @@ public class CEUndoManager
     isDisabled = false
   }
 
+  /// Performs `body`, registering the batch of mutations it applies as an undo group of its own.
+  ///
+  /// Used for edits that weren't typed, like changes made to the document elsewhere, so they're undone on their own
+  /// rather than together with the typing around them. The mutations are still recorded in the ``journal``.
+  /// Cannot be nested.
+  public func registerSeparately(_ body: () -> Void)
+  {
+    startsNewGroup = true
+    body()
+    // The typing that follows starts a group of its own too.
+    startsNewGroup = true
+  }
+
   // MARK: - Internal
 
   /// Sets a new text view to use for mutation registration, undo/redo operations.
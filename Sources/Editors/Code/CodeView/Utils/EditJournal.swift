@@ -0,0 +1,279 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeViewCore
+import Foundation
+
+/// An append-only journal of the edits made to a document since it was last saved.
+///
+/// Every mutation is encoded as a small record and appended to the journal file, so the cost of keeping the journal
+/// scales with the size of each edit rather than the size of the document. Writes are buffered on a background queue
+/// and synced to disk together at most once every ``syncInterval``.
+///
+/// After a crash, ``recover(onto:)`` replays the records onto the text of the last save. Each record carries a
+/// checksum, so a record torn by the crash is dropped along with everything after it.
+///
+/// The journal doesn't observe wholesale text replacements such as `CodeView.setText(_:)`. Owners should call
+/// ``reset(baseline:)`` after those, and after every save.
+public final class EditJournal
+{
+  /// How long appended records may wait before they're written and synced, in seconds.
+  public var syncInterval: TimeInterval = 0.5
+
+  /// The location of the journal file.
+  public let url: URL
+
+  private let queue = DispatchQueue(label: "foundation.wabi.CodeView.EditJournal", qos: .utility)
+  /// The file handle, only accessed on `queue`.
+  private var handle: FileHandle?
+  /// Records waiting to be written, only accessed on `queue`.
+  private var pending = Data()
+  private var isSyncScheduled = false
+
+  private static let magic: UInt32 = 0x314A_524B // "KRJ1"
+  private static let headerSize = 24
+  private static let recordHeaderSize = 20
+  private static let checksumSize = 4
+
+  /// Opens the journal at `url`, creating the file if needed. Nothing is written until ``recover(onto:)`` or
+  /// ``reset(baseline:)`` is called.
+  public init?(url: URL)
+  {
+    if !FileManager.default.fileExists(atPath: url.path)
+    {
+      try? FileManager.default.createDirectory(
+        at: url.deletingLastPathComponent(),
+        withIntermediateDirectories: true
+      )
+      guard FileManager.default.createFile(atPath: url.path, contents: nil) else { return nil }
+    }
+    guard let handle = try? FileHandle(forUpdating: url) else { return nil }
+    self.url = url
+    self.handle = handle
+  }
+
+  // MARK: - Recording
+
+  /// Records that the text in `range` was replaced with `string`. Records must be appended in the order the edits
+  /// were applied, with ranges relative to the text at the time of each edit.
+  public func append(replacing range: NSRange, with string: String)
+  {
+    let record = Self.encodeRecord(range: range, string: string)
+    queue.async
+    { [self] in
+      pending.append(record)
+      scheduleSync()
+    }
+  }
+
+  /// Discards every record and starts a new journal for `baseline`, the text as it is on disk. The baseline is
+  /// fingerprinted on the journal's queue, so the caller doesn't wait on a pass over the whole document.
+  public func reset(baseline: String)
+  {
+    queue.async
+    { [self] in
+      let header = Self.encodeHeader(baseline: baseline)
+      pending.removeAll()
+      guard let handle else { return }
+      try? handle.truncate(atOffset: 0)
+      try? handle.write(contentsOf: header)
+      try? handle.synchronize()
+    }
+  }
+
+  /// Writes and syncs every pending record, blocking until they're on disk.
+  public func flush()
+  {
+    queue.sync
+    {
+      sync()
+    }
+  }
+
+  /// Closes and deletes the journal, for when the document is closed without unsaved changes.
+  public func remove()
+  {
+    queue.sync
+    {
+      pending.removeAll()
+      try? handle?.close()
+      handle = nil
+      try? FileManager.default.removeItem(at: url)
+    }
+  }
+
+  // MARK: - Recovery
+
+  /// Replays the journal onto `baseline`, then keeps recording after the last intact record.
+  ///
+  /// If the journal was written for different text, or holds no edits, it's reset to `baseline` instead.
+  /// - Parameter baseline: The text of the last save.
+  /// - Returns: The recovered text, or `nil` if there was nothing to recover.
+  public func recover(onto baseline: String) -> String?
+  {
+    let header = Self.encodeHeader(baseline: baseline)
+    return queue.sync
+    {
+      guard let handle else { return nil }
+      pending.removeAll()
+      try? handle.seek(toOffset: 0)
+      let data = (try? handle.readToEnd()) ?? Data()
+      if let (text, validLength) = Self.replay(data, onto: baseline, header: header)
+      {
+        try? handle.truncate(atOffset: UInt64(validLength))
+        try? handle.seekToEnd()
+        return text
+      }
+      try? handle.truncate(atOffset: 0)
+      try? handle.write(contentsOf: header)
+      try? handle.synchronize()
+      return nil
+    }
+  }
+
+  /// Replays the journal at `url` onto `baseline` without modifying it.
+  /// - Returns: The recovered text, or `nil` if the journal can't be read, doesn't match `baseline`, or holds no
+  ///            edits.
+  public static func replay(contentsOf url: URL, onto baseline: String) -> String?
+  {
+    guard let data = try? Data(contentsOf: url, options: .mappedIfSafe) else { return nil }
+    return replay(data, onto: baseline, header: encodeHeader(baseline: baseline))?.text
+  }
+
+  /// Applies every intact record in `data` to `baseline`.
+  /// - Returns: The text and the byte length of the intact records, or `nil` if the header doesn't match or there
+  ///            are no records.
+  private static func replay(_ data: Data, onto baseline: String, header: Data) -> (text: String, length: Int)?
+  {
+    guard data.count > headerSize, data.prefix(headerSize) == header else { return nil }
+    return data.withUnsafeBytes
+    { bytes -> (text: String, length: Int)? in
+      let text = NSMutableString(string: baseline)
+      var offset = headerSize
+      while offset + recordHeaderSize + checksumSize <= bytes.count
+      {
+        let location = Int(UInt64(littleEndian: bytes.loadUnaligned(fromByteOffset: offset, as: UInt64.self)))
+        let length = Int(UInt64(littleEndian: bytes.loadUnaligned(fromByteOffset: offset + 8, as: UInt64.self)))
+        let byteCount = Int(UInt32(littleEndian: bytes.loadUnaligned(fromByteOffset: offset + 16, as: UInt32.self)))
+        let end = offset + recordHeaderSize + byteCount
+        guard end + checksumSize <= bytes.count else { break }
+        let checksum = UInt32(littleEndian: bytes.loadUnaligned(fromByteOffset: end, as: UInt32.self))
+        guard checksum == fnv1a(UnsafeRawBufferPointer(rebasing: bytes[offset ..< end])),
+              location >= 0, length >= 0, location + length <= text.length
+        else
+        {
+          break
+        }
+        let string = String(decoding: UnsafeRawBufferPointer(rebasing: bytes[offset + recordHeaderSize ..< end]),
+                            as: UTF8.self)
+        text.replaceCharacters(in: NSRange(location: location, length: length), with: string)
+        offset = end + checksumSize
+      }
+      return offset > headerSize ? (text as String, offset) : nil
+    }
+  }
+
+  // MARK: - Private
+
+  /// Writes the pending records once ``syncInterval`` has passed, so bursts of typing share a single sync.
+  private func scheduleSync()
+  {
+    guard !isSyncScheduled else { return }
+    isSyncScheduled = true
+    queue.asyncAfter(deadline: .now() + syncInterval)
+    { [weak self] in
+      self?.sync()
+    }
+  }
+
+  private func sync()
+  {
+    isSyncScheduled = false
+    guard !pending.isEmpty, let handle else { return }
+    try? handle.seekToEnd()
+    try? handle.write(contentsOf: pending)
+    try? handle.synchronize()
+    pending.removeAll(keepingCapacity: true)
+  }
+
+  private static func encodeHeader(baseline: String) -> Data
+  {
+    var data = Data(capacity: headerSize)
+    append(magic, to: &data)
+    append(UInt32(0), to: &data)
+    append(UInt64(baseline.utf16.count), to: &data)
+    append(fingerprint(of: baseline), to: &data)
+    return data
+  }
+
+  private static func encodeRecord(range: NSRange, string: String) -> Data
+  {
+    let bytes = Array(string.utf8)
+    var data = Data(capacity: recordHeaderSize + bytes.count + checksumSize)
+    append(UInt64(range.location), to: &data)
+    append(UInt64(range.length), to: &data)
+    append(UInt32(bytes.count), to: &data)
+    data.append(contentsOf: bytes)
+    let checksum = data.withUnsafeBytes { fnv1a($0) }
+    append(checksum, to: &data)
+    return data
+  }
+
+  private static func append<T: FixedWidthInteger>(_ value: T, to data: inout Data)
+  {
+    withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+  }
+
+  /// A 64 bit FNV-1a hash of the string's UTF-16 units, identifying the text a journal was written against. Unlike
+  /// `Hasher`, it's stable across launches.
+  public static func fingerprint(of string: String) -> UInt64
+  {
+    var hash: UInt64 = 0xCBF2_9CE4_8422_2325
+    for unit in string.utf16
+    {
+      hash = (hash ^ UInt64(unit)) &* 0x0000_0100_0000_01B3
+    }
+    return hash
+  }
+
+  /// A 32 bit FNV-1a checksum, used to detect records torn by a crash.
+  private static func fnv1a(_ bytes: UnsafeRawBufferPointer) -> UInt32
+  {
+    var hash: UInt32 = 0x811C_9DC5
+    for byte in bytes
+    {
+      hash = (hash ^ UInt32(byte)) &* 0x0100_0193
+    }
+    return hash
+  }
+
+  deinit
+  {
+    // Pending blocks hold a strong reference, so nothing else can be running on the queue by now.
+    sync()
+    try? handle?.close()
+  }
+}
@@ -25,6 +25,7 @@
  * -------------------------------------------------------------- */
 
 import AppKit
+import CodeViewCore
 
 public enum LineEnding: String, CaseIterable
 {
@@ -75,6 +76,23 @@ public enum LineEnding: String, CaseIterable
       }
     }
 
+    return mostCommon(in: histogram)
+  }
+
+  /// Picks the line ending used most often in a document.
+  /// - Parameter histogram: The line endings counted by ``LineBreakScanner``.
+  /// - Returns: A line ending. Defaults to `.lf` if there's no single most common ending.
+  public static func mostCommon(in histogram: LineBreakScanner.Histogram) -> LineEnding
+  {
+    mostCommon(in: [
+      .lineFeed: histogram.lineFeed,
+      .carriageReturn: histogram.carriageReturn,
+      .carriageReturnLineFeed: histogram.carriageReturnLineFeed,
+    ])
+  }
+
+  private static func mostCommon(in histogram: [LineEnding: Int]) -> LineEnding
+  {
     let orderedValues = histogram.sorted(by: { $0.value > $1.value })
     // Return the max of the histogram, but if there's no max
     // we default to lineFeed. This should be a parameter in the future.
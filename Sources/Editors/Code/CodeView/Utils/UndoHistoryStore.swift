@@ -0,0 +1,238 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Text kept by the undo history, either in memory, compressed in memory, or spilled to disk.
+struct UndoText
+{
+  enum Storage
+  {
+    case string(String)
+    case compressed(UndoHistoryStore.CompressedText)
+    case spilled(offset: UInt64, length: Int, isCompressed: Bool)
+  }
+
+  var storage: Storage
+  /// The length of the text in UTF-16 code units.
+  let utf16Length: Int
+  /// The last character of the text, kept so undo grouping can check for line endings without loading the text.
+  let last: Character?
+
+  var isEmpty: Bool
+  {
+    utf16Length == 0
+  }
+
+  /// The text, if it's held uncompressed in memory.
+  var string: String?
+  {
+    if case let .string(string) = storage
+    {
+      string
+    }
+    else
+    {
+      nil
+    }
+  }
+
+  /// The bytes of text held in memory. Shared compressed buffers count towards every text referencing them.
+  var cost: Int
+  {
+    switch storage
+    {
+      case let .string(string):
+        string.utf8.count
+      case let .compressed(compressed):
+        compressed.data.count
+      case .spilled:
+        0
+    }
+  }
+}
+
+/// Stores the text of undo mutations within a memory budget.
+///
+/// Large strings are compressed, and identical compressed buffers are shared between mutations, so repeatedly
+/// pasting the same block only keeps one copy. Once the history is over budget, ``CEUndoManager`` asks the store to
+/// spill the text of its oldest groups to an unlinked temporary file, which is reclaimed by the OS even if the app
+/// crashes.
+final class UndoHistoryStore
+{
+  /// A compressed buffer, shared by every mutation storing the same text.
+  final class CompressedText
+  {
+    let data: Data
+
+    init(data: Data)
+    {
+      self.data = data
+    }
+  }
+
+  private struct WeakCompressedText
+  {
+    weak var text: CompressedText?
+  }
+
+  /// Strings with at least this many UTF-16 code units are compressed.
+  static let compressionThreshold = 4096
+  /// Texts smaller than this many bytes aren't worth spilling to disk.
+  static let spillThreshold = 256
+
+  /// Compressed buffers by hash, used to share identical buffers.
+  private var compressedTexts: [Int: WeakCompressedText] = [:]
+  private var spillFile: FileHandle?
+  private var spillFileSize: UInt64 = 0
+
+  /// Stores a string, compressing it if it's large.
+  func store(_ string: String) -> UndoText
+  {
+    let utf16Length = string.utf16.count
+    guard utf16Length >= Self.compressionThreshold,
+          let data = try? (Data(string.utf8) as NSData).compressed(using: .lzfse) as Data
+    else
+    {
+      return UndoText(storage: .string(string), utf16Length: utf16Length, last: string.last)
+    }
+    return UndoText(storage: .compressed(share(data)), utf16Length: utf16Length, last: string.last)
+  }
+
+  /// Loads the string of a text.
+  /// - Returns: The string, or `nil` if a spilled text couldn't be read back.
+  func string(for text: UndoText) -> String?
+  {
+    switch text.storage
+    {
+      case let .string(string):
+        return string
+      case let .compressed(compressed):
+        return decompress(compressed.data)
+      case let .spilled(offset, length, isCompressed):
+        guard let spillFile,
+              (try? spillFile.seek(toOffset: offset)) != nil,
+              let data = try? spillFile.read(upToCount: length),
+              data.count == length
+        else
+        {
+          return nil
+        }
+        return isCompressed ? decompress(data) : String(decoding: data, as: UTF8.self)
+    }
+  }
+
+  /// Writes a text held in memory to the spill file.
+  /// - Returns: The spilled text, or the text unchanged if it's too small to spill or can't be written.
+  func spill(_ text: UndoText) -> UndoText
+  {
+    guard text.cost >= Self.spillThreshold else { return text }
+    let data: Data
+    let isCompressed: Bool
+    switch text.storage
+    {
+      case let .string(string):
+        data = Data(string.utf8)
+        isCompressed = false
+      case let .compressed(compressed):
+        data = compressed.data
+        isCompressed = true
+      case .spilled:
+        return text
+    }
+    guard let spillFile = openSpillFile(),
+          (try? spillFile.seekToEnd()) != nil,
+          (try? spillFile.write(contentsOf: data)) != nil
+    else
+    {
+      return text
+    }
+    let offset = spillFileSize
+    spillFileSize += UInt64(data.count)
+    return UndoText(
+      storage: .spilled(offset: offset, length: data.count, isCompressed: isCompressed),
+      utf16Length: text.utf16Length,
+      last: text.last
+    )
+  }
+
+  /// Discards all spilled text. Texts still referencing the spill file can no longer be loaded.
+  func removeAll()
+  {
+    compressedTexts.removeAll()
+    try? spillFile?.truncate(atOffset: 0)
+    spillFileSize = 0
+  }
+
+  // MARK: - Private
+
+  private func share(_ data: Data) -> CompressedText
+  {
+    let hash = data.hashValue
+    if let existing = compressedTexts[hash]?.text, existing.data == data
+    {
+      return existing
+    }
+    if compressedTexts.count > 1024
+    {
+      compressedTexts = compressedTexts.filter { $0.value.text != nil }
+    }
+    let compressed = CompressedText(data: data)
+    compressedTexts[hash] = WeakCompressedText(text: compressed)
+    return compressed
+  }
+
+  private func decompress(_ data: Data) -> String?
+  {
+    guard let decompressed = try? (data as NSData).decompressed(using: .lzfse) as Data else { return nil }
+    return String(decoding: decompressed, as: UTF8.self)
+  }
+
+  /// Creates the spill file the first time it's needed, unlinking it right away so it's removed when closed.
+  private func openSpillFile() -> FileHandle?
+  {
+    if let spillFile
+    {
+      return spillFile
+    }
+    let url = FileManager.default.temporaryDirectory
+      .appendingPathComponent("foundation.wabi.CodeView.Undo-\(UUID().uuidString)")
+    guard FileManager.default.createFile(atPath: url.path, contents: nil),
+          let handle = try? FileHandle(forUpdating: url)
+    else
+    {
+      return nil
+    }
+    try? FileManager.default.removeItem(at: url)
+    spillFile = handle
+    return handle
+  }
+
+  deinit
+  {
+    try? spillFile?.close()
+  }
+}
@@ -0,0 +1,319 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// An ordered set of non-overlapping ranges that stays valid as the text changes, by shifting the ranges following
+/// each edit.
+///
+/// Ranges are kept in blocks of up to ``blockCapacity``, stored relative to their block's offset. An edit rewrites
+/// only the blocks it touches and moves the offsets of the blocks after it, so an edit costs
+/// `O(n / blockCapacity + blockCapacity)` for `n` ranges instead of `O(n)`. The same goes for inserting a batch of
+/// results as they stream in.
+public struct SearchResultIndex
+{
+  private struct Block
+  {
+    var offset: Int
+    var ranges: [NSRange]
+
+    var firstLocation: Int
+    {
+      ranges[0].location + offset
+    }
+
+    var lastMax: Int
+    {
+      NSMaxRange(ranges[ranges.count - 1]) + offset
+    }
+
+    func range(at index: Int) -> NSRange
+    {
+      NSRange(location: ranges[index].location + offset, length: ranges[index].length)
+    }
+  }
+
+  /// The most ranges kept in one block.
+  static var blockCapacity: Int { 256 }
+
+  /// Blocks in document order. None of them is empty.
+  private var blocks: [Block] = []
+
+  /// The number of ranges in the index.
+  public private(set) var count: Int = 0
+
+  public var isEmpty: Bool
+  {
+    count == 0
+  }
+
+  /// Every range in the index, in document order.
+  public var ranges: [NSRange]
+  {
+    var ranges: [NSRange] = []
+    ranges.reserveCapacity(count)
+    for block in blocks
+    {
+      ranges.append(contentsOf: block.ranges.indices.lazy.map(block.range(at:)))
+    }
+    return ranges
+  }
+
+  public init() {}
+
+  // MARK: - Queries
+
+  /// The ranges intersecting `range`, in document order.
+  public func ranges(intersecting range: NSRange) -> [NSRange]
+  {
+    var result: [NSRange] = []
+    var blockIndex = self.blockIndex(endingAfter: range.location)
+    while blockIndex < blocks.count, blocks[blockIndex].firstLocation < NSMaxRange(range)
+    {
+      let block = blocks[blockIndex]
+      var index = block.ranges.partitioningIndex { NSMaxRange($0) + block.offset > range.location }
+      while index < block.ranges.count
+      {
+        let found = block.range(at: index)
+        guard found.location < NSMaxRange(range) else { return result }
+        result.append(found)
+        index += 1
+      }
+      blockIndex += 1
+    }
+    return result
+  }
+
+  /// The first range starting at or after `location`.
+  public func first(startingAt location: Int) -> NSRange?
+  {
+    for block in blocks[blockIndex(endingAfter: location)...]
+    {
+      let index = block.ranges.partitioningIndex { $0.location + block.offset >= location }
+      if index < block.ranges.count
+      {
+        return block.range(at: index)
+      }
+    }
+    return nil
+  }
+
+  /// The last range ending at or before `location`.
+  public func last(endingAt location: Int) -> NSRange?
+  {
+    for block in blocks[..<min(blockIndex(endingAfter: location) + 1, blocks.count)].reversed()
+    {
+      let index = block.ranges.partitioningIndex { NSMaxRange($0) + block.offset > location }
+      if index > 0
+      {
+        return block.range(at: index - 1)
+      }
+    }
+    return nil
+  }
+
+  /// The first range in the index.
+  public var first: NSRange?
+  {
+    blocks.first.map { $0.range(at: 0) }
+  }
+
+  /// The last range in the index.
+  public var last: NSRange?
+  {
+    blocks.last.map { $0.range(at: $0.ranges.count - 1) }
+  }
+
+  // MARK: - Mutation
+
+  /// Inserts ranges found by a search.
+  /// - Parameter newRanges: Ranges in document order. A range overlapping one before it is dropped.
+  public mutating func insert(contentsOf newRanges: [NSRange])
+  {
+    guard let firstNew = newRanges.first, let lastNew = newRanges.last else { return }
+    var lower = blockIndex(endingAfter: firstNew.location)
+    let upper = blockIndex(startingAtOrAfter: NSMaxRange(lastNew), from: lower)
+    if lower == upper, lower > 0
+    {
+      // The batch falls between two blocks, so grow the earlier one rather than adding a small block.
+      lower -= 1
+    }
+    var merged: [NSRange] = []
+    merged.reserveCapacity(newRanges.count + (upper - lower) * Self.blockCapacity)
+    var dropped = 0
+
+    // Searches running on separate chunks can find overlapping matches where the chunks meet, so the later of two
+    // overlapping ranges is dropped.
+    func append(_ range: NSRange)
+    {
+      if let last = merged.last, NSMaxRange(last) > range.location
+      {
+        dropped += 1
+        return
+      }
+      merged.append(range)
+    }
+
+    var newIndex = 0
+    for block in blocks[lower ..< upper]
+    {
+      for index in block.ranges.indices
+      {
+        let existing = block.range(at: index)
+        while newIndex < newRanges.count, newRanges[newIndex].location < existing.location
+        {
+          append(newRanges[newIndex])
+          newIndex += 1
+        }
+        append(existing)
+      }
+    }
+    for range in newRanges[newIndex...]
+    {
+      append(range)
+    }
+    count += newRanges.count - dropped
+    replaceBlocks(lower ..< upper, with: merged)
+  }
+
+  /// Updates the index for an edit replacing the text in `range` with `replacementLength` units.
+  ///
+  /// Ranges overlapping the edit, or containing an insertion, are removed. Ranges after the edit are moved.
+  public mutating func applyEdit(range: NSRange, replacementLength: Int)
+  {
+    let lower = blockIndex(endingAfter: range.location)
+    guard lower < blocks.count else { return }
+    let upper = blockIndex(startingAtOrAfter: NSMaxRange(range), from: lower)
+    let delta = replacementLength - range.length
+
+    var following = upper
+    if lower < upper
+    {
+      var kept: [NSRange] = []
+      kept.reserveCapacity((upper - lower) * Self.blockCapacity)
+      for block in blocks[lower ..< upper]
+      {
+        for index in block.ranges.indices
+        {
+          var existing = block.range(at: index)
+          if existing.location < NSMaxRange(range), NSMaxRange(existing) > range.location
+          {
+            count -= 1
+            continue
+          }
+          if existing.location >= NSMaxRange(range)
+          {
+            existing.location += delta
+          }
+          kept.append(existing)
+        }
+      }
+      following = replaceBlocks(lower ..< upper, with: kept)
+    }
+
+    guard delta != 0 else { return }
+    for index in following ..< blocks.count
+    {
+      blocks[index].offset += delta
+    }
+  }
+
+  /// Removes the ranges overlapping `range`.
+  public mutating func remove(intersecting range: NSRange)
+  {
+    applyEdit(range: range, replacementLength: range.length)
+  }
+
+  public mutating func removeAll()
+  {
+    blocks.removeAll()
+    count = 0
+  }
+
+  // MARK: - Private
+
+  /// The index of the first block with a range ending after `location`, or `blocks.count` if there's none.
+  private func blockIndex(endingAfter location: Int) -> Int
+  {
+    blocks.partitioningIndex { $0.lastMax > location }
+  }
+
+  /// The index of the first block, from `lower`, starting at or after `location`.
+  private func blockIndex(startingAtOrAfter location: Int, from lower: Int) -> Int
+  {
+    blocks[lower...].partitioningIndex { $0.firstLocation >= location }
+  }
+
+  /// Replaces `span` with blocks holding `ranges`.
+  /// - Returns: The index of the first block after the new blocks.
+  @discardableResult
+  private mutating func replaceBlocks(_ span: Range<Int>, with ranges: [NSRange]) -> Int
+  {
+    var newBlocks: [Block] = []
+    newBlocks.reserveCapacity((ranges.count + Self.blockCapacity - 1) / Self.blockCapacity)
+    var start = 0
+    while start < ranges.count
+    {
+      let end = min(start + Self.blockCapacity, ranges.count)
+      let offset = ranges[start].location
+      newBlocks.append(
+        Block(
+          offset: offset,
+          ranges: ranges[start ..< end].map { NSRange(location: $0.location - offset, length: $0.length) }
+        )
+      )
+      start = end
+    }
+    blocks.replaceSubrange(span, with: newBlocks)
+    return span.lowerBound + newBlocks.count
+  }
+}
+
+private extension Collection
+{
+  /// The index of the first element matching `predicate`, which must be `false` for a prefix of the collection and
+  /// `true` for the rest.
+  func partitioningIndex(where predicate: (Element) -> Bool) -> Index
+  {
+    var low = startIndex
+    var length = count
+    while length > 0
+    {
+      let half = length / 2
+      let middle = index(low, offsetBy: half)
+      if predicate(self[middle])
+      {
+        length = half
+      }
+      else
+      {
+        low = index(after: middle)
+        length -= half + 1
+      }
+    }
+    return low
+  }
+}
@@ -0,0 +1,167 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Literal substring search over UTF-16 and UTF-8 buffers.
+///
+/// Candidates are found a block of code units at a time by comparing the haystack against the needle's first unit
+/// and, `needle.count - 1` units further on, against its last unit. Only positions where both match are compared in
+/// full, so on typical text almost every block is rejected without looking at individual units. Blocks are 16 UTF-16
+/// units or 32 UTF-8 bytes, both 256 bits wide.
+public enum SubstringSearch
+{
+  /// Finds the locations of every non-overlapping occurrence of `needle` in `haystack`, in order.
+  /// - Parameters:
+  ///   - needle: The units to search for. Must not be empty.
+  ///   - haystack: The units to search in.
+  ///   - isCaseSensitive: When `false`, ASCII letters match regardless of case.
+  ///   - limit: Only occurrences starting before this offset are returned. Defaults to the end of `haystack`.
+  /// - Returns: The offsets of the occurrences in `haystack`.
+  public static func locations(
+    of needle: UnsafeBufferPointer<unichar>,
+    in haystack: UnsafeBufferPointer<unichar>,
+    isCaseSensitive: Bool = true,
+    limit: Int? = nil
+  ) -> [Int]
+  {
+    locations(SIMD16<UInt16>.self, of: needle, in: haystack, isCaseSensitive: isCaseSensitive, limit: limit)
+  }
+
+  /// Finds the byte offsets of every non-overlapping occurrence of `needle` in UTF-8 `haystack`, in order.
+  /// - Parameters:
+  ///   - needle: The UTF-8 bytes to search for. Must not be empty.
+  ///   - haystack: The UTF-8 bytes to search in.
+  ///   - isCaseSensitive: When `false`, ASCII letters match regardless of case.
+  ///   - limit: Only occurrences starting before this offset are returned. Defaults to the end of `haystack`.
+  /// - Returns: The offsets of the occurrences in `haystack`.
+  public static func locations(
+    of needle: UnsafeBufferPointer<UInt8>,
+    in haystack: UnsafeBufferPointer<UInt8>,
+    isCaseSensitive: Bool = true,
+    limit: Int? = nil
+  ) -> [Int]
+  {
+    locations(SIMD32<UInt8>.self, of: needle, in: haystack, isCaseSensitive: isCaseSensitive, limit: limit)
+  }
+
+  /// Whether a case-insensitive search for `needle` can be handled by ASCII case folding.
+  public static func canFoldCase<Unit: FixedWidthInteger>(of needle: some Sequence<Unit>) -> Bool
+  {
+    needle.allSatisfy { $0 < 0x80 }
+  }
+
+  // MARK: - Private
+
+  private static func locations<Block: SIMD>(
+    _: Block.Type,
+    of needle: UnsafeBufferPointer<Block.Scalar>,
+    in haystack: UnsafeBufferPointer<Block.Scalar>,
+    isCaseSensitive: Bool,
+    limit: Int?
+  ) -> [Int] where Block.Scalar: FixedWidthInteger & UnsignedInteger
+  {
+    typealias Unit = Block.Scalar
+    let length = needle.count
+    guard length > 0, let needleBase = needle.baseAddress, let base = haystack.baseAddress,
+          haystack.count >= length
+    else
+    {
+      return []
+    }
+    let folded = isCaseSensitive ? Array(needle) : needle.map { fold($0) }
+    // The last offset an occurrence may start at.
+    let lastStart = min(haystack.count - length, (limit ?? haystack.count) - 1)
+    let first = Block(repeating: folded[0])
+    let last = Block(repeating: folded[length - 1])
+
+    var locations: [Int] = []
+    var offset = 0
+    var nextAllowed = 0
+
+    func matches(at start: Int) -> Bool
+    {
+      if isCaseSensitive
+      {
+        return memcmp(base + start, needleBase, length * MemoryLayout<Unit>.stride) == 0
+      }
+      for idx in 0 ..< length where fold(base[start + idx]) != folded[idx]
+      {
+        return false
+      }
+      return true
+    }
+
+    while offset + Block.scalarCount - 1 <= lastStart
+    {
+      var head = UnsafeRawPointer(base + offset).loadUnaligned(as: Block.self)
+      var tail = UnsafeRawPointer(base + offset + length - 1).loadUnaligned(as: Block.self)
+      if !isCaseSensitive
+      {
+        head = fold(head)
+        tail = fold(tail)
+      }
+      let candidates = (head .== first) .& (tail .== last)
+      if any(candidates)
+      {
+        for lane in 0 ..< Block.scalarCount where candidates[lane]
+        {
+          let start = offset + lane
+          if start >= nextAllowed, matches(at: start)
+          {
+            locations.append(start)
+            nextAllowed = start + length
+          }
+        }
+      }
+      offset += Block.scalarCount
+    }
+    while offset <= lastStart
+    {
+      if offset >= nextAllowed, (isCaseSensitive ? base[offset] : fold(base[offset])) == folded[0],
+         matches(at: offset)
+      {
+        locations.append(offset)
+        nextAllowed = offset + length
+      }
+      offset += 1
+    }
+    return locations
+  }
+
+  /// Lowercases ASCII letters.
+  @inline(__always)
+  static func fold<Unit: FixedWidthInteger & UnsignedInteger>(_ unit: Unit) -> Unit
+  {
+    unit &- 0x41 < 26 ? unit | 0x20 : unit
+  }
+
+  @inline(__always)
+  private static func fold<Block: SIMD>(_ block: Block) -> Block where Block.Scalar: FixedWidthInteger
+  {
+    block.replacing(with: block | 0x20, where: (block &- 0x41) .< 26)
+  }
+}
@@ -0,0 +1,390 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Finds every match of a query in a text on background threads, streaming the matches into a
+/// ``SearchResultIndex`` as they're found.
+///
+/// The text is split into chunks searched concurrently. Literal queries use ``SubstringSearch``, with chunks
+/// overlapping by one needle so no match is lost at a boundary, and the chunks' matches are stitched together in
+/// order so none overlap. Regular expressions run on chunks that end on line boundaries, so a match can't span two
+/// chunks unless it spans a line break.
+///
+/// The engine is used from the main thread. Edits are applied to the results as they happen, and only the lines
+/// around an edit are searched again.
+public final class TextSearchEngine
+{
+  public struct Query: Hashable
+  {
+    public enum Mode: Hashable
+    {
+      case literal
+      case regularExpression
+    }
+
+    public var pattern: String
+    public var mode: Mode
+    public var isCaseSensitive: Bool
+
+    public init(_ pattern: String, mode: Mode = .literal, isCaseSensitive: Bool = false)
+    {
+      self.pattern = pattern
+      self.mode = mode
+      self.isCaseSensitive = isCaseSensitive
+    }
+  }
+
+  /// The query being searched for.
+  public private(set) var query: Query?
+
+  /// The matches found so far.
+  public private(set) var results = SearchResultIndex()
+
+  /// True while a search is running in the background.
+  public private(set) var isSearching: Bool = false
+
+  /// Called on the main thread whenever matches are added, and once more when a search finishes.
+  public var onUpdate: ((TextSearchEngine) -> Void)?
+
+  /// The length of the chunks the text is split into, in UTF-16 code units.
+  public var chunkLength: Int = 1 << 16
+
+  /// Edits covering more than this many chunks restart the whole search rather than searching around the edit.
+  private static let maxRefreshChunks = 4
+
+  private let queue = DispatchQueue(label: "foundation.wabi.CodeView.TextSearchEngine", qos: .userInitiated)
+  /// The token of the running search, cancelled when it's superseded so its results are ignored.
+  private var token: Cancellation?
+  private var matcher: Matcher?
+
+  public init() {}
+
+  // MARK: - Searching
+
+  /// Starts searching `text` for `query`, replacing any previous results.
+  /// - Parameters:
+  ///   - query: The query to search for. Searching for an empty pattern or an invalid regular expression clears the
+  ///            results.
+  ///   - text: The text to search. It's copied, so it may be edited while the search runs.
+  public func search(_ query: Query, in text: NSString)
+  {
+    cancel()
+    self.query = query
+    results.removeAll()
+    guard let matcher = Matcher(query)
+    else
+    {
+      onUpdate?(self)
+      return
+    }
+    self.matcher = matcher
+    run(matcher, in: text.copy() as! NSString)
+  }
+
+  /// Stops searching and clears the results.
+  public func clear()
+  {
+    cancel()
+    query = nil
+    matcher = nil
+    results.removeAll()
+    onUpdate?(self)
+  }
+
+  /// Updates the results for an edit, which must already have been applied to `text`.
+  ///
+  /// Matches after the edit are shifted, and the lines around the edit are searched again.
+  public func textDidChange(in range: NSRange, replacementLength: Int, text: NSString)
+  {
+    guard let matcher else { return }
+    results.applyEdit(range: range, replacementLength: replacementLength)
+    if isSearching || replacementLength > chunkLength * Self.maxRefreshChunks
+    {
+      // A running search is reading the text from before the edit, so it's started again.
+      cancel()
+      results.removeAll()
+      run(matcher, in: text.copy() as! NSString)
+      return
+    }
+    let window = matcher.window(around: NSRange(location: range.location, length: replacementLength), in: text)
+    results.remove(intersecting: window)
+    results.insert(contentsOf: matcher.matches(in: text, range: window))
+    onUpdate?(self)
+  }
+
+  /// Finds every match of `query` in `text` on the calling thread.
+  public static func matches(of query: Query, in text: NSString) -> [NSRange]
+  {
+    Matcher(query)?.matches(in: text, range: NSRange(location: 0, length: text.length)) ?? []
+  }
+
+  /// The replacement strings for every match of `query` in `text`, on the calling thread.
+  ///
+  /// Literal queries insert `template` as is. Regular expressions expand `$0`-style references in `template` for
+  /// each match.
+  public static func replacements(
+    of query: Query,
+    with template: String,
+    in text: NSString
+  ) -> [(range: NSRange, string: String)]
+  {
+    guard let matcher = Matcher(query) else { return [] }
+    let range = NSRange(location: 0, length: text.length)
+    switch matcher
+    {
+      case .literal:
+        return matcher.matches(in: text, range: range).map { ($0, template) }
+      case let .regularExpression(regex):
+        return regex.matches(in: text as String, range: range).compactMap
+        { match in
+          guard match.range.length > 0 else { return nil }
+          return (match.range, regex.replacementString(for: match, in: text as String, offset: 0, template: template))
+        }
+    }
+  }
+
+  // MARK: - Private
+
+  private func cancel()
+  {
+    token?.cancel()
+    token = nil
+    isSearching = false
+  }
+
+  private func run(_ matcher: Matcher, in text: NSString)
+  {
+    let token = Cancellation()
+    let chunks = matcher.chunks(of: text, length: chunkLength)
+    self.token = token
+    isSearching = true
+    let stitcher = Stitcher(matcher, chunks: chunks, text: text)
+    queue.async
+    { [weak self] in
+      DispatchQueue.concurrentPerform(iterations: chunks.count)
+      { index in
+        guard !token.isCancelled else { return }
+        let matches = stitcher.append(matcher.matches(in: text, range: chunks[index]), ofChunk: index)
+        DispatchQueue.main.async
+        {
+          guard let self, self.token === token, !matches.isEmpty else { return }
+          self.results.insert(contentsOf: matches)
+          self.onUpdate?(self)
+        }
+      }
+      DispatchQueue.main.async
+      {
+        guard let self, self.token === token else { return }
+        self.token = nil
+        self.isSearching = false
+        self.onUpdate?(self)
+      }
+    }
+  }
+
+  /// Joins the matches of chunks searched concurrently in document order.
+  ///
+  /// A literal match found near the end of a chunk may run into the next one, where the search of that chunk
+  /// started without knowing about it. Chunks are released in order, and the matches of each are stitched onto the
+  /// end of the last match before them, so the results are the same as searching the whole text at once.
+  private final class Stitcher
+  {
+    private let matcher: Matcher
+    private let chunks: [NSRange]
+    private let text: NSString
+    private let lock = NSLock()
+    private var pending: [Int: [NSRange]] = [:]
+    private var next = 0
+    private var end = 0
+
+    init(_ matcher: Matcher, chunks: [NSRange], text: NSString)
+    {
+      self.matcher = matcher
+      self.chunks = chunks
+      self.text = text
+    }
+
+    /// Takes the matches of the chunk at `index`, and returns the matches of every chunk that's now in order.
+    func append(_ matches: [NSRange], ofChunk index: Int) -> [NSRange]
+    {
+      lock.lock()
+      defer { lock.unlock() }
+      pending[index] = matches
+      var ready: [NSRange] = []
+      while let matches = pending.removeValue(forKey: next)
+      {
+        let stitched = matcher.stitch(matches, after: end, in: text, range: chunks[next])
+        end = max(end, stitched.last.map(NSMaxRange) ?? 0)
+        ready += stitched
+        next += 1
+      }
+      return ready
+    }
+  }
+
+  /// Lets a background search check whether it's been superseded.
+  private final class Cancellation
+  {
+    private let lock = NSLock()
+    private var _isCancelled = false
+
+    var isCancelled: Bool
+    {
+      lock.lock()
+      defer { lock.unlock() }
+      return _isCancelled
+    }
+
+    func cancel()
+    {
+      lock.lock()
+      _isCancelled = true
+      lock.unlock()
+    }
+  }
+}
+
+extension TextSearchEngine
+{
+  /// A compiled query.
+  enum Matcher
+  {
+    case literal(needle: [unichar], isCaseSensitive: Bool)
+    case regularExpression(NSRegularExpression)
+
+    init?(_ query: Query)
+    {
+      guard !query.pattern.isEmpty else { return nil }
+      let needle = Array(query.pattern.utf16)
+      if query.mode == .literal, query.isCaseSensitive || SubstringSearch.canFoldCase(of: needle)
+      {
+        self = .literal(needle: needle, isCaseSensitive: query.isCaseSensitive)
+        return
+      }
+      // Case-insensitive literals outside ASCII need Unicode case folding, so they're matched as escaped patterns.
+      var options: NSRegularExpression.Options = query.mode == .literal ? [.ignoreMetacharacters] : [.anchorsMatchLines]
+      if !query.isCaseSensitive
+      {
+        options.insert(.caseInsensitive)
+      }
+      guard let regex = try? NSRegularExpression(pattern: query.pattern, options: options) else { return nil }
+      self = .regularExpression(regex)
+    }
+
+    /// Splits `text` into ranges to search concurrently.
+    func chunks(of text: NSString, length: Int) -> [NSRange]
+    {
+      var chunks: [NSRange] = []
+      var location = 0
+      while location < text.length
+      {
+        var end = min(location + length, text.length)
+        if case .regularExpression = self, end < text.length
+        {
+          end = NSMaxRange(text.lineRange(for: NSRange(location: end, length: 0)))
+        }
+        chunks.append(NSRange(location: location, length: end - location))
+        location = end
+      }
+      return chunks
+    }
+
+    /// The range to search again after an edit to `range`, wide enough to find every match the edit could have
+    /// created or broken.
+    func window(around range: NSRange, in text: NSString) -> NSRange
+    {
+      switch self
+      {
+        case let .literal(needle, _):
+          let lower = max(range.location - needle.count + 1, 0)
+          let upper = min(NSMaxRange(range) + needle.count - 1, text.length)
+          return NSRange(location: lower, length: upper - lower)
+        case .regularExpression:
+          return text.lineRange(for: range)
+      }
+    }
+
+    /// Finds the matches starting in `range`. Literal matches may extend past the end of `range`.
+    func matches(in text: NSString, range: NSRange) -> [NSRange]
+    {
+      switch self
+      {
+        case let .literal(needle, isCaseSensitive):
+          let end = min(NSMaxRange(range) + needle.count - 1, text.length)
+          guard end - range.location >= needle.count else { return [] }
+          var buffer = [unichar](repeating: 0, count: end - range.location)
+          text.getCharacters(&buffer, range: NSRange(location: range.location, length: buffer.count))
+          let locations = buffer.withUnsafeBufferPointer
+          { haystack in
+            needle.withUnsafeBufferPointer
+            {
+              SubstringSearch.locations(
+                of: $0,
+                in: haystack,
+                isCaseSensitive: isCaseSensitive,
+                limit: range.length
+              )
+            }
+          }
+          return locations.map { NSRange(location: range.location + $0, length: needle.count) }
+        case let .regularExpression(regex):
+          var matches: [NSRange] = []
+          regex.enumerateMatches(in: text as String, options: .withTransparentBounds, range: range)
+          { match, _, _ in
+            if let match, match.range.length > 0
+            {
+              matches.append(match.range)
+            }
+          }
+          return matches
+      }
+    }
+
+    /// Joins `matches`, found in `range`, onto a previous match ending at `end`.
+    ///
+    /// Matches starting before `end` overlap the previous match and are dropped. Searching on from `end` may then
+    /// find matches that were hidden by the dropped ones, until it meets a match of `matches` again.
+    func stitch(_ matches: [NSRange], after end: Int, in text: NSString, range: NSRange) -> [NSRange]
+    {
+      guard let first = matches.first, first.location < end else { return matches }
+      var stitched: [NSRange] = []
+      var end = end
+      var index = matches.firstIndex { $0.location >= end } ?? matches.endIndex
+      while true
+      {
+        let limit = index < matches.count ? matches[index].location : NSMaxRange(range)
+        guard limit > end else { break }
+        let hidden = self.matches(in: text, range: NSRange(location: end, length: limit - end))
+        guard let last = hidden.last else { break }
+        stitched += hidden
+        end = NSMaxRange(last)
+        index = matches[index...].firstIndex { $0.location >= end } ?? matches.endIndex
+      }
+      return stitched + matches[index...]
+    }
+  }
+}
@@ -0,0 +1,415 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Searches every text file under a set of directories, streaming ranked results as they're found.
+///
+/// Files are memory-mapped and scanned concurrently by a ``WorkStealingPool``. Literal queries are matched directly
+/// against the UTF-8 bytes with ``SubstringSearch``, so a file is only decoded around its matches. Regular expressions
+/// decode the whole file. Files with skipped extensions (such as binary `.usdc` layers), files over
+/// ``maxFileSize`` and files that look binary are never read past their first few kilobytes.
+///
+/// The search runs in the background and is used from the main thread.
+public final class WorkspaceSearch
+{
+  /// A line containing a match.
+  public struct Match: Hashable
+  {
+    /// The line's number, starting at 1.
+    public let lineNumber: Int
+    /// The text of the line, shortened around the match if the line is long.
+    public let line: String
+    /// The range of the match in `line`, in UTF-16 code units.
+    public let range: NSRange
+  }
+
+  /// The matches found in one file.
+  public struct FileResult: Identifiable
+  {
+    public let url: URL
+    public let matches: [Match]
+    /// The result's rank, higher is better.
+    public let score: Double
+
+    public var id: URL
+    {
+      url
+    }
+  }
+
+  /// File extensions that are never searched, compared case-insensitively.
+  public var skippedExtensions: Set<String>
+
+  /// Files larger than this many bytes are skipped. Defaults to 32MB.
+  public var maxFileSize: Int = 32 << 20
+
+  /// The most matches kept per file.
+  public var maxMatchesPerFile: Int = 1000
+
+  /// The query being searched for.
+  public private(set) var query: TextSearchEngine.Query?
+
+  /// The results found so far, best first.
+  public private(set) var results: [FileResult] = []
+
+  /// True while a search is running in the background.
+  public private(set) var isSearching: Bool = false
+
+  /// Called on the main thread whenever results are added, and once more when a search finishes.
+  public var onUpdate: ((WorkspaceSearch) -> Void)?
+
+  private let queue = DispatchQueue(label: "foundation.wabi.CodeView.WorkspaceSearch", qos: .userInitiated)
+  private var token: Cancellation?
+
+  /// - Parameter skippedExtensions: File extensions that are never searched.
+  public init(skippedExtensions: Set<String> = [])
+  {
+    self.skippedExtensions = Set(skippedExtensions.map { $0.lowercased() })
+  }
+
+  // MARK: - Searching
+
+  /// Starts searching the files under `roots` for `query`, replacing any previous results.
+  public func search(_ query: TextSearchEngine.Query, in roots: [URL])
+  {
+    cancel()
+    self.query = query
+    results.removeAll()
+    guard !query.pattern.isEmpty
+    else
+    {
+      onUpdate?(self)
+      return
+    }
+
+    let token = Cancellation()
+    let options = Options(
+      skippedExtensions: skippedExtensions,
+      maxFileSize: maxFileSize,
+      maxMatchesPerFile: maxMatchesPerFile
+    )
+    self.token = token
+    isSearching = true
+    queue.async
+    { [weak self] in
+      let files = Self.files(in: roots, options: options, isCancelled: { token.isCancelled })
+      Self.search(files, for: query, options: options, isCancelled: { token.isCancelled })
+      { result in
+        DispatchQueue.main.async
+        {
+          guard let self, self.token === token else { return }
+          self.insert(result)
+          self.onUpdate?(self)
+        }
+      }
+      DispatchQueue.main.async
+      {
+        guard let self, self.token === token else { return }
+        self.token = nil
+        self.isSearching = false
+        self.onUpdate?(self)
+      }
+    }
+  }
+
+  /// Stops the running search. Results found so far are kept.
+  public func cancel()
+  {
+    token?.cancel()
+    token = nil
+    isSearching = false
+  }
+
+  // MARK: - Scanning
+
+  struct Options
+  {
+    var skippedExtensions: Set<String> = []
+    var maxFileSize: Int = 32 << 20
+    var maxMatchesPerFile: Int = 1000
+  }
+
+  /// Lists the regular files under `roots`, leaving out hidden files and skipped extensions.
+  static func files(in roots: [URL], options: Options, isCancelled: () -> Bool = { false }) -> [URL]
+  {
+    var files: [URL] = []
+    let keys: [URLResourceKey] = [.isRegularFileKey]
+    for root in roots
+    {
+      guard let enumerator = FileManager.default.enumerator(
+        at: root,
+        includingPropertiesForKeys: keys,
+        options: [.skipsHiddenFiles, .skipsPackageDescendants]
+      )
+      else
+      {
+        continue
+      }
+      for case let url as URL in enumerator
+      {
+        guard !isCancelled() else { return [] }
+        guard !options.skippedExtensions.contains(url.pathExtension.lowercased()),
+              (try? url.resourceValues(forKeys: Set(keys)))?.isRegularFile == true
+        else
+        {
+          continue
+        }
+        files.append(url)
+      }
+    }
+    return files
+  }
+
+  /// Searches `files` concurrently, blocking until every file has been searched or the search is cancelled.
+  /// - Parameter onResult: Called from the worker threads for every file with at least one match.
+  static func search(
+    _ files: [URL],
+    for query: TextSearchEngine.Query,
+    options: Options,
+    isCancelled: () -> Bool = { false },
+    onResult: (FileResult) -> Void
+  )
+  {
+    let needle = Array(query.pattern.utf8)
+    guard !needle.isEmpty else { return }
+    // Bytes can only be compared directly if case folding doesn't need to know about anything but ASCII.
+    let matchesBytes = query.mode == .literal && (query.isCaseSensitive || SubstringSearch.canFoldCase(of: needle))
+    WorkStealingPool(files).run
+    { url in
+      guard !isCancelled(), let file = MappedFile(url: url, maxSize: options.maxFileSize), !file.looksBinary
+      else
+      {
+        return
+      }
+      let matches = matchesBytes
+        ? file.matches(of: needle, isCaseSensitive: query.isCaseSensitive, limit: options.maxMatchesPerFile)
+        : file.matches(of: query, limit: options.maxMatchesPerFile)
+      guard !matches.isEmpty else { return }
+      onResult(FileResult(url: url, matches: matches, score: score(url, matches: matches, query: query)))
+    }
+  }
+
+  /// Ranks files whose name contains the query first, then files with more matches.
+  static func score(_ url: URL, matches: [Match], query: TextSearchEngine.Query) -> Double
+  {
+    let options: String.CompareOptions = query.isCaseSensitive ? [] : [.caseInsensitive]
+    let nameBonus = query.mode == .literal && url.lastPathComponent.range(of: query.pattern, options: options) != nil
+      ? 8.0
+      : 0.0
+    return nameBonus + log2(1 + Double(matches.count))
+  }
+
+  // MARK: - Private
+
+  /// Inserts a result, keeping the results ordered best first and by path for equal scores.
+  private func insert(_ result: FileResult)
+  {
+    var low = 0
+    var high = results.count
+    while low < high
+    {
+      let middle = (low + high) / 2
+      let other = results[middle]
+      if other.score > result.score || (other.score == result.score && other.url.path < result.url.path)
+      {
+        low = middle + 1
+      }
+      else
+      {
+        high = middle
+      }
+    }
+    results.insert(result, at: low)
+  }
+
+  /// Lets a background search check whether it's been superseded.
+  private final class Cancellation
+  {
+    private let lock = NSLock()
+    private var _isCancelled = false
+
+    var isCancelled: Bool
+    {
+      lock.lock()
+      defer { lock.unlock() }
+      return _isCancelled
+    }
+
+    func cancel()
+    {
+      lock.lock()
+      _isCancelled = true
+      lock.unlock()
+    }
+  }
+}
+
+/// A read-only memory mapping of a file, unmapped when released.
+private final class MappedFile
+{
+  let bytes: UnsafeBufferPointer<UInt8>
+
+  /// Maps the file at `url`, or returns `nil` if it can't be read or is larger than `maxSize`.
+  init?(url: URL, maxSize: Int)
+  {
+    let descriptor = open(url.path, O_RDONLY)
+    guard descriptor >= 0 else { return nil }
+    defer { close(descriptor) }
+    var info = stat()
+    guard fstat(descriptor, &info) == 0, Int(info.st_size) <= maxSize else { return nil }
+    let size = Int(info.st_size)
+    guard size > 0
+    else
+    {
+      bytes = UnsafeBufferPointer(start: nil, count: 0)
+      return
+    }
+    guard let address = mmap(nil, size, PROT_READ, MAP_PRIVATE, descriptor, 0),
+          address != UnsafeMutableRawPointer(bitPattern: -1)
+    else
+    {
+      return nil
+    }
+    bytes = UnsafeBufferPointer(start: address.assumingMemoryBound(to: UInt8.self), count: size)
+  }
+
+  /// True if the start of the file contains a NUL byte, as text files never do.
+  var looksBinary: Bool
+  {
+    guard let base = bytes.baseAddress else { return false }
+    return memchr(base, 0, min(bytes.count, 8192)) != nil
+  }
+
+  /// Finds the lines containing `needle` by comparing bytes.
+  func matches(of needle: [UInt8], isCaseSensitive: Bool, limit: Int) -> [WorkspaceSearch.Match]
+  {
+    let locations = needle.withUnsafeBufferPointer
+    {
+      SubstringSearch.locations(of: $0, in: bytes, isCaseSensitive: isCaseSensitive)
+    }
+    guard let base = bytes.baseAddress else { return [] }
+    var matches: [WorkspaceSearch.Match] = []
+    var lineNumber = 1
+    var lineStart = 0
+    for location in locations.prefix(limit)
+    {
+      // Count the line breaks between the last match and this one.
+      while let newline = memchr(base + lineStart, 0x0A, location - lineStart)
+      {
+        lineStart = UnsafeRawPointer(base).distance(to: newline) + 1
+        lineNumber += 1
+      }
+      let lineEnd = memchr(base + location, 0x0A, bytes.count - location)
+        .map { UnsafeRawPointer(base).distance(to: $0) } ?? bytes.count
+      matches.append(
+        Self.match(
+          lineNumber: lineNumber,
+          line: UnsafeBufferPointer(rebasing: bytes[lineStart ..< lineEnd]),
+          range: location - lineStart ..< location - lineStart + needle.count
+        )
+      )
+    }
+    return matches
+  }
+
+  /// Finds the lines containing matches of `query` by decoding the file.
+  func matches(of query: TextSearchEngine.Query, limit: Int) -> [WorkspaceSearch.Match]
+  {
+    let text = String(decoding: bytes, as: UTF8.self) as NSString
+    var matches: [WorkspaceSearch.Match] = []
+    var lineNumber = 1
+    var lineStart = 0
+    for range in TextSearchEngine.matches(of: query, in: text).prefix(limit)
+    {
+      while lineStart < range.location
+      {
+        let newline = text.range(
+          of: "\n",
+          options: .literal,
+          range: NSRange(location: lineStart, length: range.location - lineStart)
+        )
+        guard newline.location != NSNotFound else { break }
+        lineStart = NSMaxRange(newline)
+        lineNumber += 1
+      }
+      var lineEnd = 0
+      text.getLineStart(nil, end: nil, contentsEnd: &lineEnd, for: NSRange(location: range.location, length: 0))
+      let line = text.substring(with: NSRange(location: lineStart, length: lineEnd - lineStart))
+      let length = max(0, min(range.length, lineEnd - range.location))
+      matches.append(
+        WorkspaceSearch.Match(
+          lineNumber: lineNumber,
+          line: line,
+          range: NSRange(location: range.location - lineStart, length: length)
+        )
+      )
+    }
+    return matches
+  }
+
+  /// The longest line kept in a match, in bytes. Longer lines are cut around the match.
+  private static let maxLineLength = 512
+
+  /// Decodes a matched line, cutting it down around the match if it's long.
+  private static func match(
+    lineNumber: Int,
+    line: UnsafeBufferPointer<UInt8>,
+    range: Range<Int>
+  ) -> WorkspaceSearch.Match
+  {
+    var lower = 0
+    var upper = line.count
+    if upper > maxLineLength
+    {
+      lower = max(0, range.lowerBound - maxLineLength / 4)
+      upper = min(line.count, max(range.upperBound, lower + maxLineLength))
+    }
+    if upper > lower, line[upper - 1] == 0x0D
+    {
+      upper -= 1
+    }
+    func decode(_ bounds: Range<Int>) -> String
+    {
+      String(decoding: UnsafeBufferPointer(rebasing: line[bounds]), as: UTF8.self)
+    }
+    let prefix = decode(lower ..< range.lowerBound)
+    let matched = decode(range.lowerBound ..< min(range.upperBound, upper))
+    return WorkspaceSearch.Match(
+      lineNumber: lineNumber,
+      line: prefix + matched + decode(min(range.upperBound, upper) ..< upper),
+      range: NSRange(location: prefix.utf16.count, length: matched.utf16.count)
+    )
+  }
+
+  deinit
+  {
+    if let base = bytes.baseAddress
+    {
+      munmap(UnsafeMutableRawPointer(mutating: base), bytes.count)
+    }
+  }
+}
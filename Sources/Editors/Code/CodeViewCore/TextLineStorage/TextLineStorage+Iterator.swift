@@ -38,19 +38,23 @@ public extension TextLineStorage
     TextLineStorageRangeIterator(storage: self, range: range)
   }
 
+  /// Iterates lines from the one containing `minY` until a line starting at or beyond `maxY` has been returned.
+  ///
+  /// Only the first line is found with a search from the root, every line after it is reached by walking to the
+  /// in-order successor of the previous node.
+  /// - Complexity: `O(log n + m)` to return `m` lines from a storage of `n` lines.
   struct TextLineStorageYIterator: LazySequenceProtocol, IteratorProtocol
   {
     private let storage: TextLineStorage
     private let minY: CGFloat
     private let maxY: CGFloat
-    private var currentPosition: TextLinePosition?
+    private var currentPosition: NodePosition?
 
-    init(storage: TextLineStorage, minY: CGFloat, maxY: CGFloat, currentPosition: TextLinePosition? = nil)
+    init(storage: TextLineStorage, minY: CGFloat, maxY: CGFloat)
     {
       self.storage = storage
       self.minY = minY
       self.maxY = maxY
-      self.currentPosition = currentPosition
     }
 
     public mutating func next() -> TextLinePosition?
@@ -58,19 +62,18 @@ public extension TextLineStorage
       if let currentPosition
       {
         guard currentPosition.yPos < maxY,
-              let nextPosition = storage.getLine(atOffset: currentPosition.range.max),
-              nextPosition.index != currentPosition.index
+              let nextPosition = storage.position(after: currentPosition)
         else
         {
           return nil
         }
         self.currentPosition = nextPosition
-        return self.currentPosition!
+        return storage.nodes.linePosition(nextPosition)
       }
-      else if let nextPosition = storage.getLine(atPosition: minY)
+      else if let nextPosition = storage.position(atY: minY)
       {
         currentPosition = nextPosition
-        return nextPosition
+        return storage.nodes.linePosition(nextPosition)
       }
       else
       {
@@ -79,36 +82,40 @@ public extension TextLineStorage
     }
   }
 
+  /// Iterates every line intersecting `range`, in document order.
+  ///
+  /// Only the first line is found with a search from the root, every line after it is reached by walking to the
+  /// in-order successor of the previous node.
+  /// - Complexity: `O(log n + m)` to return `m` lines from a storage of `n` lines.
   struct TextLineStorageRangeIterator: LazySequenceProtocol, IteratorProtocol
   {
     private let storage: TextLineStorage
     private let range: NSRange
-    private var currentPosition: TextLinePosition?
+    private var currentPosition: NodePosition?
 
-    init(storage: TextLineStorage, range: NSRange, currentPosition: TextLinePosition? = nil)
+    init(storage: TextLineStorage, range: NSRange)
     {
       self.storage = storage
       self.range = range
-      self.currentPosition = currentPosition
     }
 
     public mutating func next() -> TextLinePosition?
     {
       if let currentPosition
       {
-        guard currentPosition.range.max < range.max,
-              let nextPosition = storage.getLine(atOffset: currentPosition.range.max)
+        guard currentPosition.textPos + storage.nodes.length[currentPosition.node] < NSMaxRange(range),
+              let nextPosition = storage.position(after: currentPosition)
         else
         {
           return nil
         }
         self.currentPosition = nextPosition
-        return self.currentPosition!
+        return storage.nodes.linePosition(nextPosition)
       }
-      else if let nextPosition = storage.getLine(atOffset: range.location)
+      else if let nextPosition = storage.nodes.search(for: range.location, root: storage.root)
       {
         currentPosition = nextPosition
-        return nextPosition
+        return storage.nodes.linePosition(nextPosition)
       }
       else
       {
@@ -122,37 +129,39 @@ extension TextLineStorage: LazySequenceProtocol
 {
   public func makeIterator() -> TextLineStorageIterator
   {
-    TextLineStorageIterator(storage: self, currentPosition: nil)
+    TextLineStorageIterator(storage: self)
   }
 
+  /// Iterates every line in the storage, in document order.
+  ///
+  /// Walks in-order successors instead of searching for each line, so a full pass over `n` lines is `O(n)`.
   public struct TextLineStorageIterator: IteratorProtocol
   {
     private let storage: TextLineStorage
-    private var currentPosition: TextLinePosition?
+    private var currentPosition: NodePosition?
 
-    init(storage: TextLineStorage, currentPosition: TextLinePosition? = nil)
+    init(storage: TextLineStorage)
     {
       self.storage = storage
-      self.currentPosition = currentPosition
     }
 
     public mutating func next() -> TextLinePosition?
     {
       if let currentPosition
       {
-        guard currentPosition.range.max < storage.length,
-              let nextPosition = storage.getLine(atOffset: currentPosition.range.max)
+        guard currentPosition.textPos + storage.nodes.length[currentPosition.node] < storage.length,
+              let nextPosition = storage.position(after: currentPosition)
         else
         {
           return nil
         }
         self.currentPosition = nextPosition
-        return self.currentPosition!
+        return storage.nodes.linePosition(nextPosition)
       }
-      else if let nextPosition = storage.getLine(atOffset: 0)
+      else if let nextPosition = storage.nodes.search(for: 0, root: storage.root)
       {
         currentPosition = nextPosition
-        return nextPosition
+        return storage.nodes.linePosition(nextPosition)
       }
       else
       {
@@ -161,3 +170,36 @@ extension TextLineStorage: LazySequenceProtocol
     }
   }
 }
+
+extension TextLineStorage
+{
+  /// Finds the line following `position` by walking to the in-order successor of its node.
+  ///
+  /// The node's length and height are read when this is called rather than when `position` was found, so callers may
+  /// update the current line (as layout does with heights) before advancing.
+  /// - Complexity: Amortized `O(1)` across a full traversal, `O(log n)` worst case.
+  /// - Parameter position: The position to advance from.
+  /// - Returns: The next line's position, or `nil` if `position` is the last line.
+  func position(after position: NodePosition) -> NodePosition?
+  {
+    let next = successor(position.node)
+    guard next != Self.null else { return nil }
+    return NodePosition(
+      node: next,
+      yPos: position.yPos + nodes.height[position.node],
+      textPos: position.textPos + nodes.length[position.node],
+      index: position.index + 1
+    )
+  }
+
+  /// Node counterpart to ``getLine(atPosition:)``, clamping positions past the end to the last line.
+  func position(atY posY: CGFloat) -> NodePosition?
+  {
+    guard posY < height
+    else
+    {
+      return count > 0 ? nodes.search(forIndex: count - 1, root: root) : nil
+    }
+    return nodes.search(forPosition: posY, root: root)
+  }
+}
@@ -0,0 +1,364 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+extension TextLineStorage
+{
+  /// A 32 bit index into the storage's ``NodePool``.
+  typealias NodeIndex = UInt32
+
+  /// The index of the sentinel node, used in place of a `nil` child or parent.
+  ///
+  /// The sentinel is always black and all of its subtree metadata is zero, so reads through it need no special
+  /// casing. Only its `parent` may be written to, during deletion.
+  static var null: NodeIndex { 0 }
+
+  func isRightChild(_ node: NodeIndex) -> Bool
+  {
+    nodes.right[nodes.parent[node]] == node
+  }
+
+  func isLeftChild(_ node: NodeIndex) -> Bool
+  {
+    nodes.left[nodes.parent[node]] == node
+  }
+
+  func minimum(_ node: NodeIndex) -> NodeIndex
+  {
+    var node = node
+    while nodes.left[node] != Self.null
+    {
+      node = nodes.left[node]
+    }
+    return node
+  }
+
+  func maximum(_ node: NodeIndex) -> NodeIndex
+  {
+    var node = node
+    while nodes.right[node] != Self.null
+    {
+      node = nodes.right[node]
+    }
+    return node
+  }
+
+  func successor(_ node: NodeIndex) -> NodeIndex
+  {
+    // If node has right child: successor is the min of this right tree
+    if nodes.right[node] != Self.null
+    {
+      return minimum(nodes.right[node])
+    }
+    // Else go upward until node is a left child
+    var node = node
+    var parent = nodes.parent[node]
+    while parent != Self.null, nodes.right[parent] == node
+    {
+      node = parent
+      parent = nodes.parent[node]
+    }
+    return parent
+  }
+
+  /// Transplants a node with another node.
+  ///
+  /// ```
+  ///         [a]
+  ///     [u]_/ \_[b]
+  /// [c]_/ \_[v]
+  ///
+  /// call: transplant(u, v)
+  ///
+  ///         [a]
+  ///     [v]_/ \_[b]
+  /// [c]_/
+  ///
+  /// ```
+  /// - Note: Leaves the task of updating tree metadata to the caller. `nodeV` may be the sentinel, in which case
+  ///         only its parent is updated.
+  /// - Parameters:
+  ///   - nodeU: The node to replace.
+  ///   - nodeV: The node to insert in place of `nodeU`
+  func transplant(_ nodeU: NodeIndex, with nodeV: NodeIndex)
+  {
+    let parent = nodes.parent[nodeU]
+    if parent == Self.null
+    {
+      root = nodeV
+    }
+    else if nodes.left[parent] == nodeU
+    {
+      nodes.left[parent] = nodeV
+    }
+    else
+    {
+      nodes.right[parent] = nodeV
+    }
+    nodes.parent[nodeV] = parent
+  }
+
+  enum Color: UInt8
+  {
+    case red
+    case black
+  }
+
+  /// Storage for every node in the tree, kept as a struct of arrays addressed by ``NodeIndex``.
+  ///
+  /// Nodes are not individually allocated objects. Each field lives in its own ``PagedArray``, so walking the tree
+  /// touches only the fields a search needs and never retains or releases a node. Removed nodes are pushed onto a
+  /// free list and their slots are reused by the next insert.
+  ///
+  /// Because pages are copy-on-write, copying the pool for a ``TextLineStorage/Snapshot`` is cheap, and later edits
+  /// only copy the pages along the paths they modify.
+  ///
+  /// Slot `0` is always the sentinel ``TextLineStorage/null``.
+  struct NodePool
+  {
+    var data: PagedArray<Data?> = PagedArray(repeating: nil, count: 1)
+    /// The length of the text line
+    var length: PagedArray<Int> = PagedArray(repeating: 0, count: 1)
+    /// The height of this text line
+    var height: PagedArray<CGFloat> = PagedArray(repeating: 0, count: 1)
+
+    /// The offset in characters of the entire left subtree
+    var leftSubtreeOffset: PagedArray<Int> = PagedArray(repeating: 0, count: 1)
+    /// The sum of the height of the nodes in the left subtree
+    var leftSubtreeHeight: PagedArray<CGFloat> = PagedArray(repeating: 0, count: 1)
+    /// The number of nodes in the left subtree
+    var leftSubtreeCount: PagedArray<UInt32> = PagedArray(repeating: 0, count: 1)
+
+    var left: PagedArray<NodeIndex> = PagedArray(repeating: TextLineStorage.null, count: 1)
+    var right: PagedArray<NodeIndex> = PagedArray(repeating: TextLineStorage.null, count: 1)
+    var parent: PagedArray<NodeIndex> = PagedArray(repeating: TextLineStorage.null, count: 1)
+    var color: PagedArray<Color> = PagedArray(repeating: .black, count: 1)
+
+    /// Slots released by removed nodes, available for reuse.
+    private var freeList: [NodeIndex] = []
+
+    /// The number of slots in use, including the sentinel.
+    var slotCount: Int { length.count }
+
+    /// Allocates a new, unlinked node.
+    mutating func allocate(data: Data, length: Int, height: CGFloat, color: Color) -> NodeIndex
+    {
+      if let node = freeList.popLast()
+      {
+        self.data[node] = data
+        self.length[node] = length
+        self.height[node] = height
+        leftSubtreeOffset[node] = 0
+        leftSubtreeHeight[node] = 0
+        leftSubtreeCount[node] = 0
+        left[node] = TextLineStorage.null
+        right[node] = TextLineStorage.null
+        parent[node] = TextLineStorage.null
+        self.color[node] = color
+        return node
+      }
+
+      precondition(slotCount < Int(NodeIndex.max), "TextLineStorage cannot store more than \(NodeIndex.max) lines")
+      self.data.append(data)
+      self.length.append(length)
+      self.height.append(height)
+      leftSubtreeOffset.append(0)
+      leftSubtreeHeight.append(0)
+      leftSubtreeCount.append(0)
+      left.append(TextLineStorage.null)
+      right.append(TextLineStorage.null)
+      parent.append(TextLineStorage.null)
+      self.color.append(color)
+      return NodeIndex(slotCount - 1)
+    }
+
+    /// Releases a node's slot for reuse. The node must already be unlinked from the tree.
+    mutating func free(_ node: NodeIndex)
+    {
+      data[node] = nil
+      freeList.append(node)
+    }
+
+    /// Removes every node, leaving only the sentinel.
+    /// - Parameter capacity: When non-zero, allocates `capacity` zeroed slots after the sentinel for a bulk build.
+    mutating func reset(capacity: Int = 0)
+    {
+      let slots = capacity + 1
+      data = PagedArray(repeating: nil, count: slots)
+      length = PagedArray(repeating: 0, count: slots)
+      height = PagedArray(repeating: 0, count: slots)
+      leftSubtreeOffset = PagedArray(repeating: 0, count: slots)
+      leftSubtreeHeight = PagedArray(repeating: 0, count: slots)
+      leftSubtreeCount = PagedArray(repeating: 0, count: slots)
+      left = PagedArray(repeating: TextLineStorage.null, count: slots)
+      right = PagedArray(repeating: TextLineStorage.null, count: slots)
+      parent = PagedArray(repeating: TextLineStorage.null, count: slots)
+      color = PagedArray(repeating: .black, count: slots)
+      freeList = []
+    }
+  }
+}
+
+// MARK: - Search
+
+extension TextLineStorage.NodePool
+{
+  /// Creates the public position for a node found by a search.
+  func linePosition(_ position: NodePosition) -> TextLinePosition
+  {
+    TextLinePosition(
+      data: data[position.node]!,
+      range: NSRange(location: position.textPos, length: length[position.node]),
+      yPos: position.yPos,
+      height: height[position.node],
+      index: position.index
+    )
+  }
+
+  /// Searches for the given offset.
+  /// - Parameters:
+  ///   - offset: The offset to look for in the document.
+  ///   - root: The root of the tree to search.
+  /// - Returns: A tuple containing a node if it was found, and the offset of the node in the document.
+  func search(for offset: Int, root: NodeIndex) -> NodePosition?
+  {
+    var currentNode = root
+    var currentOffset: Int = leftSubtreeOffset[root]
+    var currentYPosition: CGFloat = leftSubtreeHeight[root]
+    var currentIndex = Int(leftSubtreeCount[root])
+    while currentNode != TextLineStorage.null
+    {
+      let node = currentNode
+      // If index is in the range [currentOffset..<currentOffset + length) it's in the line
+      if offset == currentOffset || (offset >= currentOffset && offset < currentOffset + length[node])
+      {
+        return NodePosition(node: node, yPos: currentYPosition, textPos: currentOffset, index: currentIndex)
+      }
+      else if currentOffset > offset
+      {
+        let left = self.left[node]
+        currentOffset = (currentOffset - leftSubtreeOffset[node]) + leftSubtreeOffset[left]
+        currentYPosition = (currentYPosition - leftSubtreeHeight[node]) + leftSubtreeHeight[left]
+        currentIndex = (currentIndex - Int(leftSubtreeCount[node])) + Int(leftSubtreeCount[left])
+        currentNode = left
+      }
+      else if leftSubtreeOffset[node] < offset
+      {
+        let right = self.right[node]
+        currentOffset += length[node] + leftSubtreeOffset[right]
+        currentYPosition += height[node] + leftSubtreeHeight[right]
+        currentIndex += 1 + Int(leftSubtreeCount[right])
+        currentNode = right
+      }
+      else
+      {
+        currentNode = TextLineStorage.null
+      }
+    }
+    return nil
+  }
+
+  /// Searches for the given index.
+  /// - Parameters:
+  ///   - index: The index to look for in the document.
+  ///   - root: The root of the tree to search.
+  /// - Returns: A tuple containing a node if it was found, and the offset of the node in the document.
+  func search(forIndex index: Int, root: NodeIndex) -> NodePosition?
+  {
+    var currentNode = root
+    var currentOffset: Int = leftSubtreeOffset[root]
+    var currentYPosition: CGFloat = leftSubtreeHeight[root]
+    var currentIndex = Int(leftSubtreeCount[root])
+    while currentNode != TextLineStorage.null
+    {
+      let node = currentNode
+      if index == currentIndex
+      {
+        return NodePosition(node: node, yPos: currentYPosition, textPos: currentOffset, index: currentIndex)
+      }
+      else if currentIndex > index
+      {
+        let left = self.left[node]
+        currentOffset = (currentOffset - leftSubtreeOffset[node]) + leftSubtreeOffset[left]
+        currentYPosition = (currentYPosition - leftSubtreeHeight[node]) + leftSubtreeHeight[left]
+        currentIndex = (currentIndex - Int(leftSubtreeCount[node])) + Int(leftSubtreeCount[left])
+        currentNode = left
+      }
+      else
+      {
+        let right = self.right[node]
+        currentOffset += length[node] + leftSubtreeOffset[right]
+        currentYPosition += height[node] + leftSubtreeHeight[right]
+        currentIndex += 1 + Int(leftSubtreeCount[right])
+        currentNode = right
+      }
+    }
+    return nil
+  }
+
+  /// Searches for the line containing the given `y` value.
+  /// - Parameters:
+  ///   - posY: The position to look for, on a top down y axis.
+  ///   - root: The root of the tree to search.
+  /// - Returns: A tuple containing a node if it was found, and the offset of the node in the document.
+  func search(forPosition posY: CGFloat, root: NodeIndex) -> NodePosition?
+  {
+    var currentNode = root
+    var currentOffset: Int = leftSubtreeOffset[root]
+    var currentYPosition: CGFloat = leftSubtreeHeight[root]
+    var currentIndex = Int(leftSubtreeCount[root])
+    while currentNode != TextLineStorage.null
+    {
+      let node = currentNode
+      if posY >= currentYPosition, posY < currentYPosition + height[node]
+      {
+        return NodePosition(node: node, yPos: currentYPosition, textPos: currentOffset, index: currentIndex)
+      }
+      else if currentYPosition > posY
+      {
+        let left = self.left[node]
+        currentOffset = (currentOffset - leftSubtreeOffset[node]) + leftSubtreeOffset[left]
+        currentYPosition = (currentYPosition - leftSubtreeHeight[node]) + leftSubtreeHeight[left]
+        currentIndex = (currentIndex - Int(leftSubtreeCount[node])) + Int(leftSubtreeCount[left])
+        currentNode = left
+      }
+      else if leftSubtreeHeight[node] < posY
+      {
+        let right = self.right[node]
+        currentOffset += length[node] + leftSubtreeOffset[right]
+        currentYPosition += height[node] + leftSubtreeHeight[right]
+        currentIndex += 1 + Int(leftSubtreeCount[right])
+        currentNode = right
+      }
+      else
+      {
+        currentNode = TextLineStorage.null
+      }
+    }
+    return nil
+  }
+}
@@ -0,0 +1,115 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+public extension TextLineStorage
+{
+  /// An immutable copy of a ``TextLineStorage`` at a point in time.
+  ///
+  /// Taking a snapshot is `O(1)`: it shares the storage's node pages rather than copying them. The storage's next
+  /// edit copies the page table and then only the pages along the paths it writes to. Snapshots can be handed to
+  /// background work, such as parsing or searching, to map between offsets, line indices and positions while the
+  /// main thread keeps editing.
+  ///
+  /// - Warning: A snapshot's line structure is safe to read from any thread, but the `data` of each position is the
+  ///            same object the storage holds. Only read it from the thread that owns the storage.
+  struct Snapshot: @unchecked Sendable
+  {
+    let nodes: NodePool
+    let root: NodeIndex
+
+    /// The number of characters in the snapshot.
+    public let length: Int
+    /// The number of lines in the snapshot.
+    public let count: Int
+    /// The total height of every line in the snapshot.
+    public let height: CGFloat
+
+    public var isEmpty: Bool { count == 0 }
+
+    public var last: TextLinePosition?
+    {
+      guard count > 0, let position = nodes.search(forIndex: count - 1, root: root) else { return nil }
+      return nodes.linePosition(position)
+    }
+
+    /// Fetches a line for the given offset.
+    ///
+    /// - Complexity: `O(log n)`
+    /// - Parameter offset: The offset to fetch for.
+    /// - Returns: A ``TextLineStorage/TextLinePosition`` struct with relevant position and line information.
+    public func getLine(atOffset offset: Int) -> TextLinePosition?
+    {
+      guard let position = nodes.search(for: offset, root: root) else { return nil }
+      return nodes.linePosition(position)
+    }
+
+    /// Fetches a line for the given index.
+    ///
+    /// - Complexity: `O(log n)`
+    /// - Parameter index: The index to fetch for.
+    /// - Returns: A ``TextLineStorage/TextLinePosition`` struct with relevant position and line information.
+    public func getLine(atIndex index: Int) -> TextLinePosition?
+    {
+      guard index >= 0, index < count, let position = nodes.search(forIndex: index, root: root) else { return nil }
+      return nodes.linePosition(position)
+    }
+
+    /// Fetches a line for the given `y` value.
+    ///
+    /// - Complexity: `O(log n)`
+    /// - Parameter posY: The position to fetch for.
+    /// - Returns: A ``TextLineStorage/TextLinePosition`` struct with relevant position and line information.
+    public func getLine(atPosition posY: CGFloat) -> TextLinePosition?
+    {
+      guard posY < height else { return last }
+      guard let position = nodes.search(forPosition: posY, root: root) else { return nil }
+      return nodes.linePosition(position)
+    }
+
+    /// Finds the line index and the column within that line for an offset.
+    ///
+    /// The end of the document maps to the end of the last line.
+    /// - Complexity: `O(log n)`
+    /// - Parameter offset: The offset to locate.
+    /// - Returns: The line index and the column, in UTF-16 code units, or `nil` if the offset is out of bounds.
+    public func lineAndColumn(forOffset offset: Int) -> (line: Int, column: Int)?
+    {
+      guard offset >= 0, offset <= length else { return nil }
+      let position = offset == length ? last : getLine(atOffset: offset)
+      guard let position else { return nil }
+      return (position.index, offset - position.range.location)
+    }
+  }
+
+  /// Creates an immutable snapshot of the storage's current lines.
+  /// - Complexity: `O(1)`. No node data is copied.
+  func snapshot() -> Snapshot
+  {
+    Snapshot(nodes: nodes, root: root, length: length, count: count, height: height)
+  }
+}
@@ -39,15 +39,6 @@ extension TextLineStorage where Data: Identifiable
       self.index = index
     }
 
-    init(position: NodePosition)
-    {
-      data = position.node.data
-      range = NSRange(location: position.textPos, length: position.node.length)
-      yPos = position.yPos
-      height = position.node.height
-      index = position.index
-    }
-
     /// The data stored at the position
     public let data: Data
     /// The range represented by the data
@@ -63,7 +54,7 @@ extension TextLineStorage where Data: Identifiable
   struct NodePosition
   {
     /// The node storing information and the data stored at the position.
-    let node: Node<Data>
+    let node: NodeIndex
     /// The y position of the data, on a top down y axis
     let yPos: CGFloat
     /// The location of the node in the document
@@ -72,29 +63,15 @@ extension TextLineStorage where Data: Identifiable
     let index: Int
   }
 
-  struct NodeSubtreeMetadata
+  public struct BuildItem
   {
-    let height: CGFloat
-    let offset: Int
-    let count: Int
-
-    static var zero: NodeSubtreeMetadata
+    public init(data: Data, length: Int, height: CGFloat?)
     {
-      NodeSubtreeMetadata(height: 0, offset: 0, count: 0)
-    }
-
-    static func + (lhs: NodeSubtreeMetadata, rhs: NodeSubtreeMetadata) -> NodeSubtreeMetadata
-    {
-      NodeSubtreeMetadata(
-        height: lhs.height + rhs.height,
-        offset: lhs.offset + rhs.offset,
-        count: lhs.count + rhs.count
-      )
+      self.data = data
+      self.length = length
+      self.height = height
     }
-  }
 
-  public struct BuildItem
-  {
     public let data: Data
     public let length: Int
     public let height: CGFloat?
@@ -0,0 +1,642 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+// Disabling the file length here due to the fact that we want to keep certain methods private even to this package.
+// Specifically, all rotation and fixup methods must be kept private.
+// swiftlint:disable file_length
+
+// Nodes are stored in a `NodePool`, a struct of paged arrays addressed by 32 bit indices, rather than as a tree
+// of class instances. Swift has a hard time optimizing retain/release calls for object trees (the previous
+// implementation needed `Unmanaged` references to keep `metaFixup` fast), whereas walking indices into arrays of
+// trivial values involves no reference counting at all. It also cuts per-line memory roughly in half, since each
+// line no longer pays for an object header, a heap allocation, and three 64 bit child/parent pointers.
+//
+// Slot `0` of the pool is a black sentinel standing in for `nil`, in the style of CLRS. Its metadata is always zero,
+// so searches read through missing children without branching.
+
+/// Implements a red-black tree for efficiently editing, storing and retrieving lines of text in a document.
+public final class TextLineStorage<Data: Identifiable>
+{
+  private enum MetaFixupAction
+  {
+    case inserted
+    case deleted
+    case none
+  }
+
+  var nodes = NodePool()
+  var root: NodeIndex = TextLineStorage.null
+
+  /// The number of characters in the storage object.
+  public private(set) var length: Int = 0
+  /// The number of lines in the storage object
+  public private(set) var count: Int = 0
+
+  public var isEmpty: Bool { count == 0 }
+
+  public var height: CGFloat = 0
+
+  public var first: TextLinePosition?
+  {
+    guard count > 0, let position = nodes.search(forIndex: 0, root: root) else { return nil }
+    return nodes.linePosition(position)
+  }
+
+  public var last: TextLinePosition?
+  {
+    guard count > 0, let position = nodes.search(forIndex: count - 1, root: root) else { return nil }
+    return nodes.linePosition(position)
+  }
+
+  private var lastNode: NodePosition?
+  {
+    guard count > 0, let position = nodes.search(forIndex: count - 1, root: root) else { return nil }
+    return position
+  }
+
+  public init() {}
+
+  // MARK: - Public Methods
+
+  /// Inserts a new line for the given range.
+  /// - Complexity: `O(log n)` where `n` is the number of lines in the storage object.
+  /// - Parameters:
+  ///   - line: The text line to insert
+  ///   - index: The offset to insert the line at.
+  ///   - length: The length of the new line.
+  ///   - height: The height of the new line.
+  public func insert(line: Data, atOffset index: Int, length: Int, height: CGFloat)
+  {
+    assert(index >= 0 && index <= self.length, "Invalid index, expected between 0 and \(self.length). Got \(index)")
+    defer
+    {
+      self.count += 1
+      self.length += length
+      self.height += height
+    }
+
+    let insertedNode = nodes.allocate(data: line, length: length, height: height, color: .black)
+    guard root != Self.null
+    else
+    {
+      root = insertedNode
+      return
+    }
+    nodes.color[insertedNode] = .red
+
+    var currentNode = root
+    var currentOffset: Int = nodes.leftSubtreeOffset[root]
+    while true
+    {
+      if currentOffset >= index
+      {
+        let left = nodes.left[currentNode]
+        guard left != Self.null
+        else
+        {
+          nodes.left[currentNode] = insertedNode
+          break
+        }
+        currentOffset = (currentOffset - nodes.leftSubtreeOffset[currentNode]) + nodes.leftSubtreeOffset[left]
+        currentNode = left
+      }
+      else
+      {
+        let right = nodes.right[currentNode]
+        guard right != Self.null
+        else
+        {
+          nodes.right[currentNode] = insertedNode
+          break
+        }
+        currentOffset += nodes.length[currentNode] + nodes.leftSubtreeOffset[right]
+        currentNode = right
+      }
+    }
+    nodes.parent[insertedNode] = currentNode
+
+    metaFixup(startingAt: insertedNode, delta: length, deltaHeight: height, nodeAction: .inserted)
+    insertFixup(node: insertedNode)
+  }
+
+  /// Fetches a line for the given offset.
+  ///
+  /// - Complexity: `O(log n)`
+  /// - Parameter offset: The offset to fetch for.
+  /// - Returns:A  ``TextLineStorage/TextLinePosition`` struct with relevant position and line information.
+  public func getLine(atOffset offset: Int) -> TextLinePosition?
+  {
+    guard let nodePosition = nodes.search(for: offset, root: root) else { return nil }
+    return nodes.linePosition(nodePosition)
+  }
+
+  /// Fetches a line for the given index.
+  ///
+  /// - Complexity: `O(log n)`
+  /// - Parameter index: The index to fetch for.
+  /// - Returns: A  ``TextLineStorage/TextLinePosition`` struct with relevant position and line information.
+  public func getLine(atIndex index: Int) -> TextLinePosition?
+  {
+    guard let nodePosition = nodes.search(forIndex: index, root: root) else { return nil }
+    return nodes.linePosition(nodePosition)
+  }
+
+  /// Fetches a line for the given `y` value.
+  ///
+  /// - Complexity: `O(log n)`
+  /// - Parameter position: The position to fetch for.
+  /// - Returns: A  ``TextLineStorage/TextLinePosition`` struct with relevant position and line information.
+  public func getLine(atPosition posY: CGFloat) -> TextLinePosition?
+  {
+    guard posY < height
+    else
+    {
+      return last
+    }
+
+    guard let position = nodes.search(forPosition: posY, root: root) else { return nil }
+    return nodes.linePosition(position)
+  }
+
+  /// Applies a length change at the given index.
+  ///
+  /// If a character was deleted, delta should be negative.
+  /// The `index` parameter should represent where the edit began.
+  ///
+  /// Lines will be deleted if the delta is both negative and encompasses the entire line.
+  ///
+  /// If the delta goes beyond the line's range, an error will be thrown.
+  /// - Complexity `O(m log n)` where `m` is the number of lines that need to be deleted as a result of this update.
+  ///              and `n` is the number of lines stored in the tree.
+  /// - Parameters:
+  ///   - index: The index where the edit began
+  ///   - delta: The change in length of the document. Negative for deletes, positive for insertions.
+  ///   - deltaHeight: The change in height of the document.
+  public func update(atIndex index: Int, delta: Int, deltaHeight: CGFloat)
+  {
+    assert(index >= 0 && index <= length, "Invalid index, expected between 0 and \(length). Got \(index)")
+    assert(delta != 0 || deltaHeight != 0, "Delta must be non-0")
+    let position: NodePosition? = if index == length
+    { // Updates at the end of the document are valid
+      lastNode
+    }
+    else
+    {
+      nodes.search(for: index, root: root)
+    }
+    guard let position
+    else
+    {
+      assertionFailure("No line found at index \(index)")
+      return
+    }
+    if delta < 0
+    {
+      assert(
+        index - position.textPos > delta,
+        "Delta too large. Deleting \(-delta) from line at position \(index) extends beyond the line's range."
+      )
+    }
+    length += delta
+    height += deltaHeight
+    nodes.length[position.node] += delta
+    nodes.height[position.node] += deltaHeight
+    metaFixup(startingAt: position.node, delta: delta, deltaHeight: deltaHeight)
+  }
+
+  /// Deletes the line containing the given index.
+  ///
+  /// Will exit silently if a line could not be found for the given index, and throw an assertion error if the index
+  /// is out of bounds.
+  /// - Parameter index: The index to delete a line at.
+  public func delete(lineAt index: Int)
+  {
+    assert(index >= 0 && index <= length, "Invalid index, expected between 0 and \(length). Got \(index)")
+    guard count > 1
+    else
+    {
+      removeAll()
+      return
+    }
+    guard let node = nodes.search(for: index, root: root)?.node
+    else
+    {
+      assertionFailure("Failed to find node for index: \(index)")
+      return
+    }
+    count -= 1
+    length -= nodes.length[node]
+    height -= nodes.height[node]
+    deleteNode(node)
+    nodes.free(node)
+  }
+
+  public func removeAll()
+  {
+    nodes.reset()
+    root = Self.null
+    count = 0
+    length = 0
+    height = 0
+  }
+
+  /// Efficiently builds the tree from the given array of lines.
+  ///
+  /// Nodes are laid out in document order, so line `i` is stored at slot `i + 1` of the node pool. Every level of
+  /// the tree is black except the deepest, which is red, keeping the black height equal along every path.
+  /// - Note: Calls ``TextLineStorage/removeAll()`` before building.
+  /// - Parameter lines: The lines to use to build the tree.
+  public func build(from lines: borrowing[BuildItem], estimatedLineHeight: CGFloat)
+  {
+    removeAll()
+    guard !lines.isEmpty else { return }
+    precondition(lines.count < Int(NodeIndex.max), "TextLineStorage cannot store more than \(NodeIndex.max) lines")
+
+    nodes.reset(capacity: lines.count)
+    for idx in 0 ..< lines.count
+    {
+      let node = NodeIndex(idx + 1)
+      nodes.data[node] = lines[idx].data
+      nodes.length[node] = lines[idx].length
+      nodes.height[node] = lines[idx].height ?? estimatedLineHeight
+      length += nodes.length[node]
+      height += nodes.height[node]
+    }
+
+    let deepestLevel = Int.bitWidth - lines.count.leadingZeroBitCount - 1
+    root = build(left: 0, right: lines.count, parent: Self.null, depth: 0, deepestLevel: deepestLevel).node
+    nodes.color[root] = .black
+    count = lines.count
+  }
+
+  /// Recursively links a subtree of the lines already placed in the node pool, given a left and right index.
+  /// - Parameters:
+  ///   - left: The left index to use.
+  ///   - right: The right index to use.
+  ///   - parent: The parent of the subtree, the sentinel if this is the root.
+  ///   - depth: The depth of the subtree's root.
+  ///   - deepestLevel: The depth of the deepest level of the tree, which is colored red.
+  /// - Returns: A node, if available, along with it's subtree's height, offset and count.
+  private func build(
+    left: Int,
+    right: Int,
+    parent: NodeIndex,
+    depth: Int,
+    deepestLevel: Int
+  ) -> (node: NodeIndex, offset: Int, height: CGFloat, count: Int)
+  { // swiftlint:disable:this large_tuple
+    guard left < right else { return (Self.null, 0, 0, 0) }
+    let mid = left + (right - left) / 2
+    let node = NodeIndex(mid + 1)
+    nodes.parent[node] = parent
+    nodes.color[node] = depth == deepestLevel ? .red : .black
+
+    let leftSubtree = build(left: left, right: mid, parent: node, depth: depth + 1, deepestLevel: deepestLevel)
+    let rightSubtree = build(left: mid + 1, right: right, parent: node, depth: depth + 1, deepestLevel: deepestLevel)
+    nodes.left[node] = leftSubtree.node
+    nodes.right[node] = rightSubtree.node
+    nodes.leftSubtreeOffset[node] = leftSubtree.offset
+    nodes.leftSubtreeHeight[node] = leftSubtree.height
+    nodes.leftSubtreeCount[node] = UInt32(leftSubtree.count)
+
+    return (
+      node,
+      nodes.length[node] + leftSubtree.offset + rightSubtree.offset,
+      nodes.height[node] + leftSubtree.height + rightSubtree.height,
+      1 + leftSubtree.count + rightSubtree.count
+    )
+  }
+}
+
+private extension TextLineStorage
+{
+  // MARK: - Delete
+
+  /// A basic RB-Tree node removal with specialization for node metadata.
+  /// - Note: Leaves the node's slot allocated, the caller is responsible for freeing it.
+  /// - Parameter nodeZ: The node to remove.
+  func deleteNode(_ nodeZ: NodeIndex)
+  {
+    metaFixup(startingAt: nodeZ, delta: -nodes.length[nodeZ], deltaHeight: -nodes.height[nodeZ], nodeAction: .deleted)
+
+    var nodeX: NodeIndex
+    var originalColor = nodes.color[nodeZ]
+
+    if nodes.left[nodeZ] == Self.null || nodes.right[nodeZ] == Self.null
+    {
+      nodeX = nodes.right[nodeZ] != Self.null ? nodes.right[nodeZ] : nodes.left[nodeZ]
+      transplant(nodeZ, with: nodeX)
+    }
+    else
+    {
+      let nodeY = minimum(nodes.right[nodeZ])
+
+      // Delete nodeY from it's original place in the tree.
+      metaFixup(startingAt: nodeY, delta: -nodes.length[nodeY], deltaHeight: -nodes.height[nodeY], nodeAction: .deleted)
+
+      originalColor = nodes.color[nodeY]
+      nodeX = nodes.right[nodeY]
+      if nodes.parent[nodeY] == nodeZ
+      {
+        nodes.parent[nodeX] = nodeY
+      }
+      else
+      {
+        // nodeY is the minimum of its subtree, so it has no left children and nodeX's own left subtree is
+        // unchanged by moving it up.
+        transplant(nodeY, with: nodeX)
+        nodes.right[nodeY] = nodes.right[nodeZ]
+        nodes.parent[nodes.right[nodeY]] = nodeY
+      }
+      transplant(nodeZ, with: nodeY)
+      nodes.left[nodeY] = nodes.left[nodeZ]
+      nodes.parent[nodes.left[nodeY]] = nodeY
+      nodes.color[nodeY] = nodes.color[nodeZ]
+      nodes.leftSubtreeCount[nodeY] = nodes.leftSubtreeCount[nodeZ]
+      nodes.leftSubtreeHeight[nodeY] = nodes.leftSubtreeHeight[nodeZ]
+      nodes.leftSubtreeOffset[nodeY] = nodes.leftSubtreeOffset[nodeZ]
+
+      // We've inserted nodeY again into a new spot. Update tree meta
+      metaFixup(startingAt: nodeY, delta: nodes.length[nodeY], deltaHeight: nodes.height[nodeY], nodeAction: .inserted)
+    }
+
+    if originalColor == .black
+    {
+      deleteFixup(node: nodeX)
+    }
+    nodes.parent[Self.null] = Self.null
+  }
+
+  // MARK: - Fixup
+
+  func insertFixup(node: NodeIndex)
+  {
+    var nodeX = node
+    while nodeX != root, nodes.color[nodes.parent[nodeX]] == .red
+    {
+      let parent = nodes.parent[nodeX]
+      let grandparent = nodes.parent[parent]
+      if nodes.left[grandparent] == parent
+      {
+        let nodeY = nodes.right[grandparent]
+        if nodes.color[nodeY] == .red
+        {
+          nodes.color[parent] = .black
+          nodes.color[nodeY] = .black
+          nodes.color[grandparent] = .red
+          nodeX = grandparent
+        }
+        else
+        {
+          if nodes.right[parent] == nodeX
+          {
+            nodeX = parent
+            leftRotate(node: nodeX)
+          }
+          nodes.color[nodes.parent[nodeX]] = .black
+          nodes.color[nodes.parent[nodes.parent[nodeX]]] = .red
+          rightRotate(node: nodes.parent[nodes.parent[nodeX]])
+        }
+      }
+      else
+      {
+        let nodeY = nodes.left[grandparent]
+        if nodes.color[nodeY] == .red
+        {
+          nodes.color[parent] = .black
+          nodes.color[nodeY] = .black
+          nodes.color[grandparent] = .red
+          nodeX = grandparent
+        }
+        else
+        {
+          if nodes.left[parent] == nodeX
+          {
+            nodeX = parent
+            rightRotate(node: nodeX)
+          }
+          nodes.color[nodes.parent[nodeX]] = .black
+          nodes.color[nodes.parent[nodes.parent[nodeX]]] = .red
+          leftRotate(node: nodes.parent[nodes.parent[nodeX]])
+        }
+      }
+    }
+
+    nodes.color[root] = .black
+  }
+
+  /// Restores the red-black properties after removing a black node.
+  /// - Parameter node: The node that took the removed node's place. May be the sentinel, whose parent was set by
+  ///                   ``transplant(_:with:)``.
+  func deleteFixup(node: NodeIndex)
+  {
+    var nodeX = node
+    while nodeX != root, nodes.color[nodeX] == .black
+    {
+      let parent = nodes.parent[nodeX]
+      if nodeX == nodes.left[parent]
+      {
+        var sibling = nodes.right[parent]
+        if nodes.color[sibling] == .red
+        {
+          nodes.color[sibling] = .black
+          nodes.color[parent] = .red
+          leftRotate(node: parent)
+          sibling = nodes.right[parent]
+        }
+
+        if nodes.color[nodes.left[sibling]] == .black, nodes.color[nodes.right[sibling]] == .black
+        {
+          setColor(sibling, .red)
+          nodeX = parent
+        }
+        else
+        {
+          if nodes.color[nodes.right[sibling]] == .black
+          {
+            setColor(nodes.left[sibling], .black)
+            setColor(sibling, .red)
+            rightRotate(node: sibling)
+            sibling = nodes.right[parent]
+          }
+          setColor(sibling, nodes.color[parent])
+          nodes.color[parent] = .black
+          setColor(nodes.right[sibling], .black)
+          leftRotate(node: parent)
+          nodeX = root
+        }
+      }
+      else
+      {
+        var sibling = nodes.left[parent]
+        if nodes.color[sibling] == .red
+        {
+          nodes.color[sibling] = .black
+          nodes.color[parent] = .red
+          rightRotate(node: parent)
+          sibling = nodes.left[parent]
+        }
+
+        if nodes.color[nodes.right[sibling]] == .black, nodes.color[nodes.left[sibling]] == .black
+        {
+          setColor(sibling, .red)
+          nodeX = parent
+        }
+        else
+        {
+          if nodes.color[nodes.left[sibling]] == .black
+          {
+            setColor(nodes.right[sibling], .black)
+            setColor(sibling, .red)
+            leftRotate(node: sibling)
+            sibling = nodes.left[parent]
+          }
+          setColor(sibling, nodes.color[parent])
+          nodes.color[parent] = .black
+          setColor(nodes.left[sibling], .black)
+          rightRotate(node: parent)
+          nodeX = root
+        }
+      }
+    }
+    setColor(nodeX, .black)
+  }
+
+  /// Sets a node's color, ignoring writes to the sentinel so it stays black.
+  func setColor(_ node: NodeIndex, _ color: Color)
+  {
+    guard node != Self.null else { return }
+    nodes.color[node] = color
+  }
+
+  /// Walk up the tree, updating any `leftSubtree` metadata.
+  private func metaFixup(
+    startingAt node: NodeIndex,
+    delta: Int,
+    deltaHeight: CGFloat,
+    nodeAction: MetaFixupAction = .none
+  )
+  {
+    var child = node
+    var parent = nodes.parent[child]
+    while parent != Self.null
+    {
+      if nodes.left[parent] == child
+      {
+        nodes.leftSubtreeOffset[parent] += delta
+        nodes.leftSubtreeHeight[parent] += deltaHeight
+        switch nodeAction
+        {
+          case .inserted:
+            nodes.leftSubtreeCount[parent] += 1
+          case .deleted:
+            nodes.leftSubtreeCount[parent] -= 1
+          case .none:
+            break
+        }
+      }
+      child = parent
+      parent = nodes.parent[child]
+    }
+  }
+}
+
+// MARK: - Rotations
+
+private extension TextLineStorage
+{
+  func rightRotate(node: NodeIndex)
+  {
+    rotate(node: node, left: false)
+  }
+
+  func leftRotate(node: NodeIndex)
+  {
+    rotate(node: node, left: true)
+  }
+
+  func rotate(node: NodeIndex, left: Bool)
+  {
+    let nodeY: NodeIndex
+
+    if left
+    {
+      nodeY = nodes.right[node]
+      guard nodeY != Self.null else { return }
+      nodes.leftSubtreeOffset[nodeY] += nodes.leftSubtreeOffset[node] + nodes.length[node]
+      nodes.leftSubtreeHeight[nodeY] += nodes.leftSubtreeHeight[node] + nodes.height[node]
+      nodes.leftSubtreeCount[nodeY] += nodes.leftSubtreeCount[node] + 1
+      nodes.right[node] = nodes.left[nodeY]
+      if nodes.right[node] != Self.null
+      {
+        nodes.parent[nodes.right[node]] = node
+      }
+    }
+    else
+    {
+      nodeY = nodes.left[node]
+      guard nodeY != Self.null else { return }
+      // The node's left subtree loses nodeY and nodeY's left subtree, keeping only nodeY's right subtree.
+      nodes.leftSubtreeOffset[node] -= nodes.leftSubtreeOffset[nodeY] + nodes.length[nodeY]
+      nodes.leftSubtreeHeight[node] -= nodes.leftSubtreeHeight[nodeY] + nodes.height[nodeY]
+      nodes.leftSubtreeCount[node] -= nodes.leftSubtreeCount[nodeY] + 1
+      nodes.left[node] = nodes.right[nodeY]
+      if nodes.left[node] != Self.null
+      {
+        nodes.parent[nodes.left[node]] = node
+      }
+    }
+
+    let parent = nodes.parent[node]
+    nodes.parent[nodeY] = parent
+    if parent == Self.null
+    {
+      root = nodeY
+    }
+    else if nodes.left[parent] == node
+    {
+      nodes.left[parent] = nodeY
+    }
+    else
+    {
+      nodes.right[parent] = nodeY
+    }
+
+    if left
+    {
+      nodes.left[nodeY] = node
+    }
+    else
+    {
+      nodes.right[nodeY] = node
+    }
+    nodes.parent[node] = nodeY
+  }
+}
+
+// swiftlint:enable file_length
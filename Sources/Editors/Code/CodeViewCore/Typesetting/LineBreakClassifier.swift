@@ -0,0 +1,132 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Classifies UTF-16 code units for line breaking, using precomputed tables instead of building strings or
+/// character sets.
+///
+/// A line may break after whitespace, a line ending, or punctuation, as defined by `CharacterSet`'s
+/// `whitespacesAndNewlines` and `punctuationCharacters`. Classes are stored in a two stage table: the high byte of
+/// a code unit picks one of a few distinct 256 entry blocks, and the low byte indexes into it, so a lookup is two
+/// loads. Surrogates always classify as ``BreakClass/other``, a line never breaks inside a surrogate pair.
+public enum LineBreakClassifier
+{
+  /// The line breaking class of a code unit.
+  public enum BreakClass: UInt8
+  {
+    /// Letters, digits, symbols and anything else a line can't break after.
+    case other
+    case whitespace
+    /// Line feeds, carriage returns and other line or paragraph separators.
+    case newline
+    case punctuation
+  }
+
+  /// Finds the class of a code unit.
+  @inline(__always)
+  public static func breakClass(of unit: unichar) -> BreakClass
+  {
+    let table = Self.table
+    let block = Int(table.stage1[Int(unit >> 8)])
+    return BreakClass(rawValue: table.stage2[block << 8 | Int(unit & 0xFF)])!
+  }
+
+  /// True if a line can break after a code unit.
+  @inline(__always)
+  public static func canBreakLine(after unit: unichar) -> Bool
+  {
+    breakClass(of: unit) != .other
+  }
+
+  /// True if the units before and at `index` are a CRLF (`\r\n`) line ending, which a line can't break inside.
+  /// - Parameters:
+  ///   - string: The string to check in.
+  ///   - index: The index of the unit after the potential break.
+  public static func isInsideCarriageReturnLineFeed(_ string: NSString, at index: Int) -> Bool
+  {
+    index > 0
+      && index < string.length
+      && string.character(at: index - 1) == 0x0D
+      && string.character(at: index) == 0x0A
+  }
+
+  // MARK: - Tables
+
+  private struct Table
+  {
+    /// The block each high byte uses.
+    let stage1: [UInt8]
+    /// Every distinct block of 256 classes, concatenated.
+    let stage2: [UInt8]
+  }
+
+  private static let table: Table = {
+    let newlines = CharacterSet.newlines
+    let whitespace = CharacterSet.whitespacesAndNewlines
+    let punctuation = CharacterSet.punctuationCharacters
+
+    var stage1 = [UInt8](repeating: 0, count: 256)
+    var stage2: [UInt8] = []
+    var blocks: [[UInt8]: UInt8] = [:]
+    for high in 0 ..< 256
+    {
+      let block = (0 ..< 256).map
+      { low -> UInt8 in
+        guard let scalar = Unicode.Scalar(UInt32(high << 8 | low)) else { return BreakClass.other.rawValue }
+        let unitClass: BreakClass = if newlines.contains(scalar)
+        {
+          .newline
+        }
+        else if whitespace.contains(scalar)
+        {
+          .whitespace
+        }
+        else if punctuation.contains(scalar)
+        {
+          .punctuation
+        }
+        else
+        {
+          .other
+        }
+        return unitClass.rawValue
+      }
+      if let index = blocks[block]
+      {
+        stage1[high] = index
+      }
+      else
+      {
+        let index = UInt8(blocks.count)
+        blocks[block] = index
+        stage1[high] = index
+        stage2.append(contentsOf: block)
+      }
+    }
+    return Table(stage1: stage1, stage2: stage2)
+  }()
+}
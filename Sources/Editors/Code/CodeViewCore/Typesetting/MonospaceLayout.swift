@@ -0,0 +1,249 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Lays out lines of monospaced text arithmetically, from column counts rather than glyph metrics.
+///
+/// Every character that isn't a tab or line ending advances by one column, or two for East Asian wide characters, so
+/// wrap points and fragment widths can be found without a typesetter. Anything the column model can't describe, like
+/// combining marks, emoji or control characters, makes ``layout(_:metrics:maxWidth:breakStrategy:)`` return `nil` so
+/// the caller can fall back to CoreText.
+///
+/// Breaks match `Typesetter`'s CoreText path: a fragment holds as many characters as fit in the width, and the word
+/// strategy then walks back up to 100 characters to break after whitespace or punctuation.
+public enum MonospaceLayout
+{
+  /// The measurements used to lay out a line.
+  public struct Metrics: Equatable
+  {
+    /// - Parameters:
+    ///   - advance: The width of one column, including any kern.
+    ///   - tabInterval: The distance between tab stops. Lines containing tabs aren't laid out if this is `0`.
+    public init(advance: CGFloat, tabInterval: CGFloat)
+    {
+      self.advance = advance
+      self.tabInterval = tabInterval
+    }
+
+    public let advance: CGFloat
+    public let tabInterval: CGFloat
+  }
+
+  /// A laid out fragment of a line.
+  public struct Fragment: Equatable
+  {
+    /// The length of the fragment in UTF-16 code units.
+    public let length: Int
+    /// The width of the fragment, including any trailing whitespace.
+    public let width: CGFloat
+  }
+
+  /// How a code unit advances the pen.
+  enum Advance: Equatable
+  {
+    /// Line endings take no space.
+    case none
+    case columns(Int)
+    /// Advances to the next tab stop.
+    case tab
+  }
+
+  /// Lays out a line.
+  /// - Parameters:
+  ///   - characters: The line's UTF-16 code units, including its line ending.
+  ///   - metrics: The font's measurements.
+  ///   - maxWidth: The width to wrap the line at, `.greatestFiniteMagnitude` to never wrap.
+  ///   - breakStrategy: Determines how line breaks are chosen.
+  /// - Returns: The line's fragments, empty for an empty line, or `nil` if the line contains characters that need
+  ///            a typesetter.
+  /// - Complexity: `O(n)`
+  public static func layout(
+    _ characters: UnsafeBufferPointer<unichar>,
+    metrics: Metrics,
+    maxWidth: CGFloat,
+    breakStrategy: LineBreakStrategy
+  ) -> [Fragment]?
+  {
+    var advances: [Advance] = []
+    advances.reserveCapacity(characters.count)
+    for unit in characters
+    {
+      guard let unitAdvance = advance(of: unit), unitAdvance != .tab || metrics.tabInterval > 0 else { return nil }
+      advances.append(unitAdvance)
+    }
+
+    var fragments: [Fragment] = []
+    var start = 0
+    while start < characters.count
+    {
+      let fit = fittingLength(advances, from: start, metrics: metrics, maxWidth: maxWidth)
+      let end = switch breakStrategy
+      {
+        case .character:
+          start + fit
+        case .word:
+          wordBreak(characters, from: start, fittingLength: fit)
+      }
+      fragments.append(Fragment(length: end - start, width: width(advances[start ..< end], metrics: metrics)))
+      start = end
+    }
+    return fragments
+  }
+
+  /// Lays out a line of a string.
+  /// - Parameters:
+  ///   - string: The string containing the line.
+  ///   - range: The range of the line in `string`.
+  /// - Returns: The line's fragments, empty for an empty line, or `nil` if the line contains characters that need
+  ///            a typesetter.
+  public static func layout(
+    _ string: NSString,
+    range: NSRange,
+    metrics: Metrics,
+    maxWidth: CGFloat,
+    breakStrategy: LineBreakStrategy
+  ) -> [Fragment]?
+  {
+    withUnsafeTemporaryAllocation(of: unichar.self, capacity: max(range.length, 1))
+    { buffer in
+      string.getCharacters(buffer.baseAddress!, range: range)
+      return layout(
+        UnsafeBufferPointer(rebasing: buffer[0 ..< range.length]),
+        metrics: metrics,
+        maxWidth: maxWidth,
+        breakStrategy: breakStrategy
+      )
+    }
+  }
+
+  // MARK: - Columns
+
+  /// Finds how a code unit advances the pen, or `nil` if it can't be laid out in columns.
+  static func advance(of unit: unichar) -> Advance?
+  {
+    switch unit
+    {
+      case 0x20 ... 0x7E:
+        .columns(1)
+      case 0x09:
+        .tab
+      case 0x0A, 0x0D:
+        Advance.none
+      case 0x1100 ... 0x115F, // Hangul Jamo initial consonants
+           0x2E80 ... 0x303E, // CJK radicals, Kangxi radicals, ideographic description, CJK symbols and punctuation
+           0x3041 ... 0x33FF, // Hiragana, Katakana, Bopomofo, Hangul compatibility Jamo, Kanbun, CJK compatibility
+           0x3400 ... 0x4DBF, // CJK unified ideographs extension A
+           0x4E00 ... 0x9FFF, // CJK unified ideographs
+           0xA000 ... 0xA4CF, // Yi syllables and radicals
+           0xAC00 ... 0xD7A3, // Hangul syllables
+           0xF900 ... 0xFAFF, // CJK compatibility ideographs
+           0xFE30 ... 0xFE4F, // CJK compatibility forms
+           0xFF00 ... 0xFF60, // Fullwidth forms
+           0xFFE0 ... 0xFFE6: // Fullwidth signs
+        .columns(2)
+      default:
+        nil
+    }
+  }
+
+  /// True if a code unit is an East Asian wide character, taking two columns.
+  public static func isWide(_ unit: unichar) -> Bool
+  {
+    advance(of: unit) == .columns(2)
+  }
+
+  /// Finds how many code units fit in a width, always at least one. Line endings take no space and always fit.
+  private static func fittingLength(
+    _ advances: [Advance],
+    from start: Int,
+    metrics: Metrics,
+    maxWidth: CGFloat
+  ) -> Int
+  {
+    var x: CGFloat = 0
+    var index = start
+    while index < advances.count
+    {
+      let next = position(after: advances[index], at: x, metrics: metrics)
+      if next > x, next > maxWidth, index > start
+      {
+        break
+      }
+      x = next
+      index += 1
+    }
+    return index - start
+  }
+
+  private static func width(_ advances: ArraySlice<Advance>, metrics: Metrics) -> CGFloat
+  {
+    advances.reduce(0) { position(after: $1, at: $0, metrics: metrics) }
+  }
+
+  /// The pen position after a code unit. Tab stops are measured from the start of the fragment, like a `CTLine`.
+  private static func position(after advance: Advance, at x: CGFloat, metrics: Metrics) -> CGFloat
+  {
+    switch advance
+    {
+      case .none:
+        x
+      case let .columns(columns):
+        x + CGFloat(columns) * metrics.advance
+      case .tab:
+        ((x / metrics.tabInterval).rounded(.down) + 1) * metrics.tabInterval
+    }
+  }
+
+  // MARK: - Breaks
+
+  /// Moves a break back to the last whitespace or punctuation, mirroring `Typesetter.suggestLineBreakForWord`.
+  private static func wordBreak(_ characters: UnsafeBufferPointer<unichar>, from start: Int, fittingLength: Int) -> Int
+  {
+    let breakIndex = start + fittingLength
+    let canLastCharacterBreak = breakIndex - 1 > 0
+      && LineBreakClassifier.canBreakLine(after: characters[breakIndex - 1])
+    guard breakIndex < characters.count, !canLastCharacterBreak
+    else
+    {
+      // Breaking either at the end of the string, or on a whitespace.
+      return breakIndex
+    }
+    if breakIndex - 1 > 0
+    {
+      var index = breakIndex - 1
+      while breakIndex - index < 100, index > start
+      {
+        if LineBreakClassifier.canBreakLine(after: characters[index])
+        {
+          return index + 1
+        }
+        index -= 1
+      }
+    }
+    return breakIndex
+  }
+}
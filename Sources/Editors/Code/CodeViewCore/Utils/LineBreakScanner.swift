@@ -0,0 +1,229 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Splits a string into lines and counts the line endings it finds, in a single pass over its UTF-16 code units.
+///
+/// Lines end the same places `NSString.getLineStart(_:end:contentsEnd:for:)` ends them: after `\n`, `\r`, `\r\n`,
+/// `U+0085`, `U+2028` or `U+2029`. Code units are tested sixteen at a time, so runs of text without any line
+/// terminators are skipped with a few vector compares, and long strings are cut into chunks that are scanned
+/// concurrently before being stitched back together.
+public enum LineBreakScanner
+{
+  /// A single line, including its line ending.
+  public struct Line: Equatable
+  {
+    /// The length of the line, in UTF-16 code units.
+    public var length: Int
+
+    static let empty = Line(length: 0)
+  }
+
+  /// The number of each kind of line ending in a string.
+  public struct Histogram: Equatable
+  {
+    public var lineFeed: Int = 0
+    public var carriageReturn: Int = 0
+    public var carriageReturnLineFeed: Int = 0
+    /// `U+0085`, `U+2028` and `U+2029`, which end lines but are never used as a document's line ending.
+    public var other: Int = 0
+
+    mutating func formUnion(_ other: Histogram)
+    {
+      lineFeed += other.lineFeed
+      carriageReturn += other.carriageReturn
+      carriageReturnLineFeed += other.carriageReturnLineFeed
+      self.other += other.other
+    }
+  }
+
+  public struct Result
+  {
+    /// Every line in the string, in order. A final line with no line ending is included only if it isn't empty.
+    public var lines: [Line]
+    /// The line endings found while splitting the string.
+    public var histogram: Histogram
+  }
+
+  /// Strings shorter than twice this many code units are scanned on the calling thread.
+  static let minimumChunkLength = 1 << 18
+
+  /// Splits a string into lines.
+  ///
+  /// The string must not be mutated until this returns.
+  /// - Complexity: `O(n)` in the length of the string, spread across the available cores for long strings.
+  /// - Parameter string: The string to scan.
+  /// - Returns: The string's lines and a histogram of their line endings.
+  public static func scan(_ string: NSString) -> Result
+  {
+    scan(string, minimumChunkLength: minimumChunkLength)
+  }
+
+  static func scan(_ string: NSString, minimumChunkLength: Int) -> Result
+  {
+    let chunkRanges = ranges(of: string, minimumChunkLength: minimumChunkLength)
+    var chunks = [Chunk](repeating: Chunk(), count: chunkRanges.count)
+    if chunkRanges.count == 1
+    {
+      chunks[0] = scanChunk(string, range: chunkRanges[0])
+    }
+    else
+    {
+      chunks.withUnsafeMutableBufferPointer
+      { chunks in
+        DispatchQueue.concurrentPerform(iterations: chunkRanges.count)
+        { idx in
+          chunks[idx] = scanChunk(string, range: chunkRanges[idx])
+        }
+      }
+    }
+
+    // The first line of each chunk continues whatever was left over at the end of the previous one.
+    var result = Result(lines: [], histogram: Histogram())
+    result.lines.reserveCapacity(chunks.reduce(1) { $0 + $1.lines.count })
+    var carry = Line.empty
+    for chunk in chunks
+    {
+      for line in chunk.lines
+      {
+        result.lines.append(Line(length: carry.length + line.length))
+        carry = .empty
+      }
+      carry.length += chunk.tail.length
+      result.histogram.formUnion(chunk.histogram)
+    }
+    if carry.length > 0
+    {
+      result.lines.append(carry)
+    }
+    return result
+  }
+
+  // MARK: - Chunks
+
+  /// The lines ending inside one chunk of the string. The first line is measured from the start of the chunk.
+  private struct Chunk
+  {
+    var lines: [Line] = []
+    /// The code units after the last line ending in the chunk.
+    var tail: Line = .empty
+    var histogram = Histogram()
+  }
+
+  /// Cuts a string into roughly equal ranges, one or two per core, never separating a `\r\n` pair.
+  private static func ranges(of string: NSString, minimumChunkLength: Int) -> [NSRange]
+  {
+    let length = string.length
+    let chunkCount = min(length / max(minimumChunkLength, 1), ProcessInfo.processInfo.activeProcessorCount * 2)
+    guard chunkCount > 1 else { return [NSRange(location: 0, length: length)] }
+
+    var ranges: [NSRange] = []
+    var start = 0
+    for idx in 1 ... chunkCount
+    {
+      var end = length * idx / chunkCount
+      if end < length, end > start, string.character(at: end - 1) == 0x0D, string.character(at: end) == 0x0A
+      {
+        end += 1
+      }
+      guard end > start else { continue }
+      ranges.append(NSRange(location: start, length: end - start))
+      start = end
+    }
+    return ranges
+  }
+
+  private static func scanChunk(_ string: NSString, range: NSRange) -> Chunk
+  {
+    let blockSize = 4096
+    var chunk = Chunk()
+    var line = Line.empty
+
+    // One extra code unit is read past each block, so a `\r` at the end of a block can see a following `\n`.
+    withUnsafeTemporaryAllocation(of: unichar.self, capacity: blockSize + 1)
+    { buffer in
+      guard let units = buffer.baseAddress else { return }
+      var blockStart = range.location
+      while blockStart < NSMaxRange(range)
+      {
+        let count = min(blockSize, NSMaxRange(range) - blockStart)
+        let available = min(blockSize + 1, NSMaxRange(range) - blockStart)
+        string.getCharacters(units, range: NSRange(location: blockStart, length: available))
+
+        var idx = 0
+        while idx < count
+        {
+          if idx + Vector.scalarCount <= count
+          {
+            let vector = UnsafeRawPointer(units + idx).loadUnaligned(as: Vector.self)
+            if !any(isLineTerminator(vector))
+            {
+              line.length += Vector.scalarCount
+              idx += Vector.scalarCount
+              continue
+            }
+          }
+
+          let unit = units[idx]
+          idx += 1
+          line.length += 1
+          switch unit
+          {
+            case 0x0A:
+              chunk.histogram.lineFeed += 1
+            case 0x0D where idx < available && units[idx] == 0x0A:
+              chunk.histogram.carriageReturnLineFeed += 1
+              idx += 1
+              line.length += 1
+            case 0x0D:
+              chunk.histogram.carriageReturn += 1
+            case 0x85, 0x2028, 0x2029:
+              chunk.histogram.other += 1
+            default:
+              continue
+          }
+          chunk.lines.append(line)
+          line = .empty
+        }
+        // A `\r\n` straddling the block boundary consumes the first unit of the next block.
+        blockStart += idx
+      }
+    }
+    chunk.tail = line
+    return chunk
+  }
+
+  // MARK: - Code Units
+
+  private typealias Vector = SIMD16<UInt16>
+
+  @inline(__always)
+  private static func isLineTerminator(_ vector: Vector) -> SIMDMask<Vector.MaskStorage>
+  {
+    (vector .== 0x0A) .| (vector .== 0x0D) .| (vector .== 0x85) .| ((vector & 0xFFFE) .== 0x2028)
+  }
+}
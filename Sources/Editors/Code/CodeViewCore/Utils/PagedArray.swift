@@ -0,0 +1,85 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// A growable array split into fixed size pages, each backed by its own copy-on-write buffer.
+///
+/// Copying a `PagedArray` only copies its page table. Writing to one of the copies duplicates the page table and the
+/// single page being written to, leaving every other page shared. A structure stored in paged arrays can therefore
+/// hand out cheap immutable copies while it keeps mutating, paying only for the pages each edit touches.
+struct PagedArray<Element>
+{
+  /// Elements per page, as a power of two.
+  static var pageShift: Int { 9 }
+  static var pageSize: Int { 1 << pageShift }
+  static var pageMask: Int { pageSize - 1 }
+
+  private var pages: ContiguousArray<ContiguousArray<Element>> = []
+
+  /// The number of elements in the array.
+  private(set) var count: Int = 0
+
+  init() {}
+
+  init(repeating value: Element, count: Int)
+  {
+    pages.reserveCapacity((count + Self.pageMask) >> Self.pageShift)
+    var remaining = count
+    while remaining > 0
+    {
+      pages.append(ContiguousArray(repeating: value, count: min(remaining, Self.pageSize)))
+      remaining -= Self.pageSize
+    }
+    self.count = count
+  }
+
+  subscript(_ index: UInt32) -> Element
+  {
+    get
+    {
+      let index = Int(truncatingIfNeeded: index)
+      return pages[index >> Self.pageShift][index & Self.pageMask]
+    }
+    set
+    {
+      let index = Int(truncatingIfNeeded: index)
+      pages[index >> Self.pageShift][index & Self.pageMask] = newValue
+    }
+  }
+
+  mutating func append(_ element: Element)
+  {
+    if count & Self.pageMask == 0
+    {
+      var page = ContiguousArray<Element>()
+      page.reserveCapacity(Self.pageSize)
+      pages.append(page)
+    }
+    pages[pages.count - 1].append(element)
+    count += 1
+  }
+}
@@ -0,0 +1,333 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Computes the edits turning one text into another, so a document can be updated in place instead of replaced.
+///
+/// Bytes shared by the start and end of both texts are skipped with a plain comparison, the lines left in between are
+/// matched by hash with Myers' diff, and each changed run of lines is trimmed down to the characters that differ.
+/// Applying the result keeps everything maintained incrementally from the text (the line storage, syntax trees and
+/// highlights) valid outside of the edits.
+public enum TextDiff
+{
+  /// A replacement of a range of the original text.
+  public struct Edit: Equatable
+  {
+    /// The range replaced, in UTF-16 code units of the original text.
+    public let range: NSRange
+    /// The text replacing the range.
+    public let string: String
+
+    public init(range: NSRange, string: String)
+    {
+      self.range = range
+      self.string = string
+    }
+  }
+
+  /// Computes the edits turning `oldText` into `newText`.
+  ///
+  /// - Complexity: `O(n + (l + m) * d)` for texts of `n` bytes with `l` and `m` lines between their common start and
+  ///   end, `d` of which are inserted or deleted. Once `d` passes `limit` the lines in between are replaced as one.
+  /// - Parameters:
+  ///   - oldText: The original text.
+  ///   - newText: The text to turn it into.
+  ///   - limit: The most line insertions and deletions to search for, defaults to 1024.
+  /// - Returns: Disjoint edits in ascending order, each range relative to `oldText`.
+  public static func edits(from oldText: String, to newText: String, limit: Int = 1024) -> [Edit]
+  {
+    var oldText = oldText
+    var newText = newText
+    return oldText.withUTF8
+    { old in
+      newText.withUTF8
+      { new in
+        edits(from: old, to: new, limit: limit)
+      }
+    }
+  }
+
+  /// Applies edits computed by ``edits(from:to:limit:)`` to the text they were computed from.
+  public static func apply(_ edits: [Edit], to text: String) -> String
+  {
+    let string = NSMutableString(string: text)
+    for edit in edits.reversed()
+    {
+      string.replaceCharacters(in: edit.range, with: edit.string)
+    }
+    return string as String
+  }
+
+  typealias Bytes = UnsafeBufferPointer<UInt8>
+
+  static func edits(from old: Bytes, to new: Bytes, limit: Int) -> [Edit]
+  {
+    // Skip whole lines shared by the start and end of both texts.
+    var prefix = 0
+    while prefix < old.count, prefix < new.count, old[prefix] == new[prefix]
+    {
+      prefix += 1
+    }
+    guard prefix < old.count || prefix < new.count else { return [] }
+    while prefix > 0, old[prefix - 1] != newline
+    {
+      prefix -= 1
+    }
+    var suffix = 0
+    let maxSuffix = min(old.count, new.count) - prefix
+    while suffix < maxSuffix, old[old.count - suffix - 1] == new[new.count - suffix - 1]
+    {
+      suffix += 1
+    }
+    while suffix > 0,
+          !isLineStart(old, old.count - suffix, after: prefix) || !isLineStart(new, new.count - suffix, after: prefix)
+    {
+      suffix -= 1
+    }
+
+    let oldLines = lines(of: old, in: prefix ..< old.count - suffix)
+    let newLines = lines(of: new, in: prefix ..< new.count - suffix)
+    let hunks = changedLines(old: oldLines, in: old, new: newLines, in: new, limit: limit)
+      ?? [(0 ..< oldLines.count, 0 ..< newLines.count)]
+
+    var edits: [Edit] = []
+    edits.reserveCapacity(hunks.count)
+    var utf8Offset = 0
+    var utf16Offset = 0
+    for (oldHunk, newHunk) in hunks
+    {
+      var oldRange = byteRange(of: oldHunk, in: oldLines, end: old.count - suffix)
+      var newRange = byteRange(of: newHunk, in: newLines, end: new.count - suffix)
+      trimCommonBytes(&oldRange, in: old, &newRange, in: new)
+
+      utf16Offset += utf16Length(of: old, in: utf8Offset ..< oldRange.lowerBound)
+      let length = utf16Length(of: old, in: oldRange)
+      edits.append(Edit(
+        range: NSRange(location: utf16Offset, length: length),
+        string: String(decoding: Bytes(rebasing: new[newRange]), as: UTF8.self)
+      ))
+      utf8Offset = oldRange.upperBound
+      utf16Offset += length
+    }
+    return edits
+  }
+
+  // MARK: - Lines
+
+  /// A line of text, including its line break.
+  struct Line
+  {
+    let range: Range<Int>
+    let hash: Int
+  }
+
+  static let newline = UInt8(ascii: "\n")
+
+  /// Whether `idx` starts a line, treating `start` as the start of one.
+  static func isLineStart(_ bytes: Bytes, _ idx: Int, after start: Int) -> Bool
+  {
+    idx == start || bytes[idx - 1] == newline
+  }
+
+  /// Splits `range` into lines, hashing each one.
+  static func lines(of bytes: Bytes, in range: Range<Int>) -> [Line]
+  {
+    var lines: [Line] = []
+    var start = range.lowerBound
+    while start < range.upperBound
+    {
+      var end = start
+      while end < range.upperBound, bytes[end] != newline
+      {
+        end += 1
+      }
+      end = min(end + 1, range.upperBound)
+      var hasher = Hasher()
+      hasher.combine(bytes: UnsafeRawBufferPointer(rebasing: bytes[start ..< end]))
+      lines.append(Line(range: start ..< end, hash: hasher.finalize()))
+      start = end
+    }
+    return lines
+  }
+
+  static func equal(_ lhs: Line, in old: Bytes, _ rhs: Line, in new: Bytes) -> Bool
+  {
+    guard lhs.hash == rhs.hash, lhs.range.count == rhs.range.count else { return false }
+    return lhs.range.count == 0
+      || memcmp(old.baseAddress! + lhs.range.lowerBound, new.baseAddress! + rhs.range.lowerBound, lhs.range.count) == 0
+  }
+
+  /// The bytes covered by a run of lines, an empty run sits at the start of the line following it.
+  static func byteRange(of lineRange: Range<Int>, in lines: [Line], end: Int) -> Range<Int>
+  {
+    let start = lineRange.lowerBound < lines.count ? lines[lineRange.lowerBound].range.lowerBound : end
+    let upper = lineRange.upperBound < lines.count ? lines[lineRange.upperBound].range.lowerBound : end
+    return start ..< upper
+  }
+
+  // MARK: - Myers
+
+  /// Finds the runs of lines that differ between `old` and `new` with Myers' `O((l + m) * d)` algorithm.
+  /// - Returns: Pairs of line ranges to replace, in ascending order, or `nil` if more than `limit` lines differ.
+  static func changedLines(
+    old: [Line], in oldBytes: Bytes,
+    new: [Line], in newBytes: Bytes,
+    limit: Int
+  ) -> [(Range<Int>, Range<Int>)]?
+  {
+    let oldCount = old.count
+    let newCount = new.count
+    let maxDistance = min(oldCount + newCount, limit)
+    // The furthest x reached on each diagonal k = x - y, offset so k = -d - 1 is a valid index.
+    let offset = maxDistance + 1
+    var furthest = [Int](repeating: 0, count: 2 * maxDistance + 3)
+    // The furthest points before each step, covering diagonals -d - 1 ... d + 1, for walking back along the path.
+    var trace: [[Int]] = []
+
+    for distance in 0 ... maxDistance
+    {
+      trace.append(Array(furthest[offset - distance - 1 ... offset + distance + 1]))
+      for diagonal in stride(from: -distance, through: distance, by: 2)
+      {
+        let down = diagonal == -distance
+          || (diagonal != distance && furthest[offset + diagonal - 1] < furthest[offset + diagonal + 1])
+        var x = down ? furthest[offset + diagonal + 1] : furthest[offset + diagonal - 1] + 1
+        var y = x - diagonal
+        while x < oldCount, y < newCount, equal(old[x], in: oldBytes, new[y], in: newBytes)
+        {
+          x += 1
+          y += 1
+        }
+        furthest[offset + diagonal] = x
+        if x >= oldCount, y >= newCount
+        {
+          return hunks(trace: trace, distance: distance, oldCount: oldCount, newCount: newCount)
+        }
+      }
+    }
+    return nil
+  }
+
+  /// Walks back along the path found by ``changedLines(old:in:new:in:limit:)``, collecting the lines it skips.
+  private static func hunks(
+    trace: [[Int]],
+    distance: Int,
+    oldCount: Int,
+    newCount: Int
+  ) -> [(Range<Int>, Range<Int>)]
+  {
+    // Runs of matching lines as (old line, new line, count), from the end of the texts back to their start. Empty
+    // runs are left out so a deletion next to an insertion becomes a single replacement.
+    var matches: [(Int, Int, Int)] = [(oldCount, newCount, 0)]
+    var x = oldCount
+    var y = newCount
+    for step in stride(from: distance, to: 0, by: -1)
+    {
+      let previous = trace[step]
+      let at = { (diagonal: Int) in previous[diagonal + step + 1] }
+      let diagonal = x - y
+      let down = diagonal == -step || (diagonal != step && at(diagonal - 1) < at(diagonal + 1))
+      let previousDiagonal = down ? diagonal + 1 : diagonal - 1
+      let previousX = at(previousDiagonal)
+      let previousY = previousX - previousDiagonal
+      // The snake following the insertion (down) or deletion (right) ends at (x, y).
+      let snakeX = down ? previousX : previousX + 1
+      if x > snakeX
+      {
+        matches.append((snakeX, snakeX - diagonal, x - snakeX))
+      }
+      x = previousX
+      y = previousY
+    }
+    if x > 0
+    {
+      matches.append((0, 0, x))
+    }
+
+    var hunks: [(Range<Int>, Range<Int>)] = []
+    var oldLine = 0
+    var newLine = 0
+    for (matchOld, matchNew, count) in matches.reversed()
+    {
+      if matchOld > oldLine || matchNew > newLine
+      {
+        hunks.append((oldLine ..< matchOld, newLine ..< matchNew))
+      }
+      oldLine = matchOld + count
+      newLine = matchNew + count
+    }
+    return hunks
+  }
+
+  // MARK: - Bytes
+
+  /// Shrinks a pair of replaced byte ranges to where their contents differ, keeping whole UTF-8 sequences.
+  static func trimCommonBytes(_ oldRange: inout Range<Int>, in old: Bytes, _ newRange: inout Range<Int>, in new: Bytes)
+  {
+    var prefix = 0
+    while prefix < oldRange.count, prefix < newRange.count,
+          old[oldRange.lowerBound + prefix] == new[newRange.lowerBound + prefix]
+    {
+      prefix += 1
+    }
+    while prefix > 0,
+          prefix < oldRange.count && isContinuation(old[oldRange.lowerBound + prefix])
+          || prefix < newRange.count && isContinuation(new[newRange.lowerBound + prefix])
+    {
+      prefix -= 1
+    }
+    var suffix = 0
+    while suffix < oldRange.count - prefix, suffix < newRange.count - prefix,
+          old[oldRange.upperBound - suffix - 1] == new[newRange.upperBound - suffix - 1]
+    {
+      suffix += 1
+    }
+    while suffix > 0, isContinuation(old[oldRange.upperBound - suffix])
+    {
+      suffix -= 1
+    }
+    oldRange = oldRange.lowerBound + prefix ..< oldRange.upperBound - suffix
+    newRange = newRange.lowerBound + prefix ..< newRange.upperBound - suffix
+  }
+
+  static func isContinuation(_ byte: UInt8) -> Bool
+  {
+    byte & 0xC0 == 0x80
+  }
+
+  /// The number of UTF-16 code units encoding the UTF-8 bytes in `range`.
+  static func utf16Length(of bytes: Bytes, in range: Range<Int>) -> Int
+  {
+    var length = 0
+    for idx in range
+    {
+      let byte = bytes[idx]
+      length += isContinuation(byte) ? 0 : byte >= 0xF0 ? 2 : 1
+    }
+    return length
+  }
+}
@@ -0,0 +1,105 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Runs a fixed set of work items across worker threads that steal from each other once their own work runs out.
+///
+/// Items are split into contiguous runs, one per worker. A worker takes items from the back of its own run and, when
+/// it's empty, steals from the front of another worker's run, so a worker stuck on a few large items doesn't hold up
+/// the rest. Each run has its own lock, so workers only contend while stealing.
+final class WorkStealingPool<Item>
+{
+  private final class Run
+  {
+    let lock = NSLock()
+    var items: ArraySlice<Item>
+
+    init(_ items: ArraySlice<Item>)
+    {
+      self.items = items
+    }
+
+    func popLast() -> Item?
+    {
+      lock.lock()
+      defer { lock.unlock() }
+      return items.popLast()
+    }
+
+    func popFirst() -> Item?
+    {
+      lock.lock()
+      defer { lock.unlock() }
+      return items.popFirst()
+    }
+  }
+
+  private let runs: [Run]
+
+  /// - Parameters:
+  ///   - items: The work to do.
+  ///   - workerCount: The number of worker threads. Defaults to the number of active processors.
+  init(_ items: [Item], workerCount: Int = ProcessInfo.processInfo.activeProcessorCount)
+  {
+    let workerCount = max(1, min(workerCount, items.count))
+    let runLength = (items.count + workerCount - 1) / workerCount
+    runs = (0 ..< workerCount).map
+    { worker in
+      let start = min(worker * runLength, items.count)
+      return Run(items[start ..< min(start + runLength, items.count)])
+    }
+  }
+
+  /// Calls `body` once for every item, blocking until every item has been processed.
+  /// - Parameter body: Called concurrently from the worker threads.
+  func run(_ body: (Item) -> Void)
+  {
+    DispatchQueue.concurrentPerform(iterations: runs.count)
+    { worker in
+      while let item = next(for: worker)
+      {
+        body(item)
+      }
+    }
+  }
+
+  private func next(for worker: Int) -> Item?
+  {
+    if let item = runs[worker].popLast()
+    {
+      return item
+    }
+    for offset in 1 ..< max(runs.count, 1)
+    {
+      if let item = runs[(worker + offset) % runs.count].popFirst()
+      {
+        return item
+      }
+    }
+    return nil
+  }
+}
@@ -30,6 +30,11 @@ import TextStory
 
 extension TextViewController: CodeViewDelegate
 {
+  public func textView(_: CodeView, willReplaceContentsCovering range: NSRange)
+  {
+    highlighter?.batchWillEdit(coveredRange: range)
+  }
+
   public func textView(_: CodeView, didReplaceContentsIn _: NSRange, with _: String)
   {
     gutterView.needsDisplay = true
@@ -30,6 +30,7 @@ import CodeView
 import Combine
 import SwiftUI
 import TextFormation
+import TextStory
 
 /// # TextViewController
 ///
@@ -41,7 +42,7 @@ public class TextViewController: NSViewController
   public static let cursorPositionUpdatedNotification: Notification.Name = .init("TextViewController.cursorPositionNotification")
 
   var scrollView: NSScrollView!
-  var textView: CodeView!
+  public internal(set) var textView: CodeView!
   var gutterView: GutterView!
   var _undoManager: CEUndoManager?
   /// Internal reference to any injected layers in the text view.
@@ -184,6 +185,9 @@ public class TextViewController: NSViewController
     }
   }
 
+  /// Whether the text is being changed by ``applyText(_:)`` rather than by the user.
+  public private(set) var isApplyingText = false
+
   /// Passthrough value for the `textView`s string
   public var text: String
   {
@@ -296,6 +300,37 @@ public class TextViewController: NSViewController
     gutterView.setNeedsDisplay(gutterView.frame)
   }
 
+  /// Update the contents of the editor by editing only what changed.
+  ///
+  /// Unlike ``setText(_:)``, which reloads the editor, the differences are applied as one batch of edits, so the line
+  /// storage, syntax tree and highlights are updated incrementally. The edits are undoable as one group of their own,
+  /// and journaled like any other edit, so the undo history recorded against the previous text stays valid.
+  /// Read-only editors are reloaded instead.
+  /// - Parameter text: The new contents of the editor.
+  public func applyText(_ text: String)
+  {
+    guard textView.isEditable
+    else
+    {
+      setText(text)
+      return
+    }
+    let edits = TextDiff.edits(from: textView.string, to: text)
+    guard !edits.isEmpty else { return }
+    let length = textView.textStorage.length
+    let mutations = edits.map { TextMutation(string: $0.string, range: $0.range, limit: length) }
+    isApplyingText = true
+    if let undoManager = textView._undoManager
+    {
+      undoManager.registerSeparately { textView.replaceCharacters(mutations) }
+    }
+    else
+    {
+      textView.replaceCharacters(mutations)
+    }
+    isApplyingText = false
+  }
+
   // MARK: Paragraph Style
 
   /// A default `NSParagraphStyle` with a set `lineHeight`
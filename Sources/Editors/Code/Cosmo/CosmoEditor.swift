@@ -58,6 +58,8 @@ public extension Editor.Code
     ///   - bracketPairHighlight: The type of highlight to use to highlight bracket pairs.
     ///                           See `BracketPairHighlight` for more information. Defaults to `nil`
     ///   - undoManager: The undo manager for the text view. Defaults to `nil`, which will create a new CEUndoManager
+    ///   - documentID: Identifies the document being edited. When it changes, the text is reloaded rather than applied
+    ///                 as edits, so the previous document's text can't be undone back into the new one.
     public init(
       _ text: Binding<String>,
       language: Editor.Code.Language,
@@ -77,6 +79,7 @@ public extension Editor.Code
       letterSpacing: Double = 1.0,
       bracketPairHighlight: BracketPairHighlight? = nil,
       undoManager: CEUndoManager? = nil,
+      documentID: AnyHashable? = nil,
       coordinators: [any TextViewCoordinator] = []
     )
     {
@@ -98,6 +101,7 @@ public extension Editor.Code
       self.letterSpacing = letterSpacing
       self.bracketPairHighlight = bracketPairHighlight
       self.undoManager = undoManager
+      self.documentID = documentID
       self.coordinators = coordinators
     }
 
@@ -119,6 +123,7 @@ public extension Editor.Code
     private var letterSpacing: Double
     private var bracketPairHighlight: BracketPairHighlight?
     private var undoManager: CEUndoManager?
+    private var documentID: AnyHashable?
     private var coordinators: [any TextViewCoordinator]
 
     public typealias NSViewControllerType = TextViewController
@@ -169,6 +174,22 @@ public extension Editor.Code
 
     public func updateNSViewController(_ controller: TextViewController, context: Context)
     {
+      // Text set from outside of the editor is applied as edits rather than reloaded, keeping the line storage and
+      // syntax tree incremental. Only the text of another document is reloaded.
+      if documentID != context.coordinator.documentID
+      {
+        context.coordinator.documentID = documentID
+        context.coordinator.text = text
+        controller.setText(text)
+      }
+      else if text != context.coordinator.text
+      {
+        context.coordinator.text = text
+        context.coordinator.isUpdatingFromRepresentable = true
+        controller.applyText(text)
+        context.coordinator.isUpdatingFromRepresentable = false
+      }
+
       if !context.coordinator.isUpdateFromTextView
       {
         // Prevent infinite loop of update notifications
@@ -265,10 +286,16 @@ public extension Editor.Code
       weak var controller: TextViewController?
       var isUpdatingFromRepresentable: Bool = false
       var isUpdateFromTextView: Bool = false
+      /// The text last shown by the text view.
+      var text: String
+      /// The document the text view shows.
+      var documentID: AnyHashable?
 
       init(parent: Editor.Code.Cosmo)
       {
         self.parent = parent
+        text = parent.text
+        documentID = parent.documentID
         super.init()
 
         NotificationCenter.default.addObserver(
@@ -295,7 +322,11 @@ public extension Editor.Code
         {
           return
         }
-        parent.text = textView.string
+        text = textView.string
+        if !isUpdatingFromRepresentable
+        {
+          parent.text = text
+        }
         parent.coordinators.forEach
         {
           $0.textViewDidChangeText(controller: controller)
@@ -30,7 +30,7 @@ import SwiftTreeSitter
 
 extension InputEdit
 {
-  init?(range: NSRange, delta: Int, oldEndPoint: Point, textView: CodeView)
+  init?(range: NSRange, delta: Int, oldEndPoint: Point, lines: TextLineStorage<TextLine>.Snapshot)
   {
     let newEndLocation = NSMaxRange(range) + delta
 
@@ -41,8 +41,8 @@ extension InputEdit
     }
 
     let newRange = NSRange(location: range.location, length: range.length + delta)
-    let startPoint = textView.pointForLocation(newRange.location) ?? .zero
-    let newEndPoint = textView.pointForLocation(newEndLocation) ?? .zero
+    let startPoint = lines.pointForLocation(newRange.location) ?? .zero
+    let newEndPoint = lines.pointForLocation(newEndLocation) ?? .zero
 
     self.init(
       startByte: UInt32(range.location * 2),
@@ -37,3 +37,13 @@ extension CodeView
     return Point(row: linePosition.index, column: column)
   }
 }
+
+extension TextLineStorage.Snapshot where Data == TextLine
+{
+  /// Finds the tree-sitter point for a location without touching the text view, for use off the main thread.
+  func pointForLocation(_ location: Int) -> Point?
+  {
+    guard let position = lineAndColumn(forOffset: location) else { return nil }
+    return Point(row: position.line, column: position.column)
+  }
+}
@@ -73,6 +73,10 @@ class Highlighter: NSObject
   /// The length to chunk ranges into when passing to the highlighter.
   private let rangeChunkLimit = 1024
 
+  /// True between the start of a batch of edits and the text storage processing it, while the highlight provider
+  /// already holds the batch's combined edit.
+  private var isEditingBatch = false
+
   // MARK: - Init
 
   /// Initializes the `Highlighter`
@@ -359,6 +363,7 @@ extension Highlighter
 {
   func storageDidEdit(editedRange: NSRange, delta: Int)
   {
+    isEditingBatch = false
     guard let textView else { return }
 
     let range = NSRange(location: editedRange.location, length: editedRange.length - delta)
@@ -383,7 +388,17 @@ extension Highlighter
 
   func storageWillEdit(editedRange: NSRange)
   {
-    guard let textView else { return }
+    guard !isEditingBatch, let textView else { return }
     highlightProvider?.willApplyEdit(textView: textView, range: editedRange)
   }
+
+  /// Tells the highlight provider about a batch of edits before any of it is applied, so it sees the text before
+  /// the batch. The text storage then reports the batch as one edit covering the same range.
+  /// - Parameter coveredRange: The range covering every edit in the batch, before the batch.
+  func batchWillEdit(coveredRange: NSRange)
+  {
+    guard let textView else { return }
+    isEditingBatch = true
+    highlightProvider?.willApplyEdit(textView: textView, range: coveredRange)
+  }
 }
@@ -0,0 +1,86 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeView
+import Foundation
+import SwiftTreeSitter
+
+public extension TreeSitterClient
+{
+  /// A node of the document's syntax tree.
+  struct SyntaxNode: Hashable
+  {
+    /// The node's type, e.g. `prim_definition`.
+    public let type: String
+    /// The node's range in the document.
+    public let range: NSRange
+  }
+
+  /// Finds the nodes of the given types enclosing each range, in the primary language's syntax tree.
+  ///
+  /// The lookup is enqueued behind every edit already sent to the client, so the ranges resolve against the tree of
+  /// the text they were taken from. The completion isn't called if the client is set up again before it runs.
+  /// - Parameters:
+  ///   - ranges: The ranges to look up.
+  ///   - types: The node types to return.
+  ///   - textView: The text view the client was set up with.
+  ///   - completion: Called on the main thread with the nodes enclosing each range, outermost first.
+  func enclosingNodes(
+    of ranges: [NSRange],
+    types: Set<String>,
+    textView: CodeView,
+    completion: @escaping ([[SyntaxNode]]) -> Void
+  )
+  {
+    performAsync
+    { [weak self] in
+      let nodes = ranges.map { self?.enclosingNodes(of: $0, types: types) ?? [] }
+      DispatchQueue.main.async
+      {
+        completion(nodes)
+      }
+    }
+  }
+
+  /// Walks up from the smallest node containing `range`, collecting the nodes of the given types.
+  /// Must only be called from the operation queue.
+  private func enclosingNodes(of range: NSRange, types: Set<String>) -> [SyntaxNode]
+  {
+    guard let rootNode = state?.layers.first?.tree?.rootNode else { return [] }
+
+    var nodes: [SyntaxNode] = []
+    var node = rootNode.descendant(in: UInt32(range.location * 2) ..< UInt32(NSMaxRange(range) * 2))
+    while let current = node
+    {
+      if let type = current.nodeType, types.contains(type)
+      {
+        nodes.append(SyntaxNode(type: type, range: current.range))
+      }
+      node = current.parent
+    }
+    return nodes.reversed()
+  }
+}
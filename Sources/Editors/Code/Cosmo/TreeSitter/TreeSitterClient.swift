@@ -162,7 +162,7 @@ public final class TreeSitterClient: HighlightProviding
   ///
   /// - Note: While in debug mode, this method will throw an assertion failure if not called from the Main thread.
   /// - Parameter operation: The operation to perform
-  private func performAsync(_ operation: @escaping () -> Void)
+  func performAsync(_ operation: @escaping () -> Void)
   {
     assertMain()
     runningOperationCount += 1
@@ -237,20 +237,17 @@ public final class TreeSitterClient: HighlightProviding
     {
       textView.pointForLocation(range.max) ?? .zero
     }
+    self.oldEndPoint = nil
 
-    guard let edit = InputEdit(
-      range: range,
-      delta: delta,
-      oldEndPoint: oldEndPoint,
-      textView: textView
-    )
-    else
-    {
-      completion(IndexSet())
-      return
-    }
-
+    // Points are resolved against a snapshot of the lines, so long edits can convert them off the main thread.
+    let lines = textView.layoutManager.lineStorageSnapshot()
     let operation = { [weak self] in
+      guard let edit = InputEdit(range: range, delta: delta, oldEndPoint: oldEndPoint, lines: lines)
+      else
+      {
+        completion(IndexSet())
+        return
+      }
       let invalidatedRanges = self?.applyEdit(edit: edit) ?? IndexSet()
       completion(invalidatedRanges)
     }
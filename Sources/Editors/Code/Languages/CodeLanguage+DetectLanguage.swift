@@ -25,7 +25,6 @@
  * -------------------------------------------------------------- */
 
 import Foundation
-import RegexBuilder
 
 public extension Editor.Code.Language
 {
@@ -41,24 +40,85 @@ public extension Editor.Code.Language
   {
     if let urlLanguage = detectLanguageUsingURL(url: url)
     {
-      urlLanguage
+      return urlLanguage
     }
-    else if let prefixBuffer,
-            let shebangLanguage = detectLanguageUsingShebang(contents: prefixBuffer.lowercased())
+    guard var prefixBuffer else { return .default }
+    var suffixBuffer = suffixBuffer ?? ""
+    return prefixBuffer.withUTF8
+    { prefixBytes in
+      suffixBuffer.withUTF8
+      { suffixBytes in
+        ContentSniffer.language(prefix: prefixBytes, suffix: suffixBytes)
+      }
+    } ?? .default
+  }
+
+  /// Gets the corresponding language for the given file URL, falling back to the raw UTF-8 bytes of the document.
+  ///
+  /// Behaves like ``detectLanguageFrom(url:prefixBuffer:suffixBuffer:)`` without decoding the buffers into strings.
+  /// - Returns: A language structure
+  /// - Parameters:
+  ///   - url: The URL to get the language for.
+  ///   - prefixBytes: The first few lines of the document.
+  ///   - suffixBytes: The last few lines of the document.
+  static func detectLanguageFrom(url: URL, prefixBytes: Data, suffixBytes: Data? = nil) -> Editor.Code.Language
+  {
+    if let urlLanguage = detectLanguageUsingURL(url: url)
     {
-      shebangLanguage
+      return urlLanguage
     }
-    else if let prefixBuffer,
-            let modelineLanguage = detecLanguageUsingModeline(
-              prefixBuffer: prefixBuffer.lowercased(),
-              suffixBuffer: suffixBuffer?.lowercased()
-            )
-    {
-      modelineLanguage
+    return prefixBytes.withUnsafeBytes
+    { prefix in
+      (suffixBytes ?? Data()).withUnsafeBytes
+      { suffix in
+        ContentSniffer.language(prefix: prefix.bindMemory(to: UInt8.self), suffix: suffix.bindMemory(to: UInt8.self))
+      }
+    } ?? .default
+  }
+
+  /// Gets the corresponding language for each of the given file URLs, classifying them concurrently.
+  ///
+  /// Files are first matched by name, only the ones that aren't recognized have the first and last few lines of their
+  /// contents read and searched for a shebang or modeline.
+  /// - Returns: The language of each file, in the same order as `urls`.
+  /// - Parameters:
+  ///   - urls: The file URLs to get the languages for.
+  ///   - readingContents: Whether to read unrecognized files, defaults to `true`.
+  static func detectLanguages(for urls: [URL], readingContents: Bool = true) -> [Editor.Code.Language]
+  {
+    var languages = [Editor.Code.Language](repeating: .default, count: urls.count)
+    let chunkCount = (urls.count + batchChunkLength - 1) / batchChunkLength
+    languages.withUnsafeMutableBufferPointer
+    { buffer in
+      DispatchQueue.concurrentPerform(iterations: chunkCount)
+      { chunk in
+        let start = chunk * batchChunkLength
+        for idx in start ..< min(start + batchChunkLength, urls.count)
+        {
+          if let language = detectLanguageUsingURL(url: urls[idx])
+          {
+            buffer[idx] = language
+          }
+          else if readingContents, let language = ContentSniffer.language(contentsOf: urls[idx])
+          {
+            buffer[idx] = language
+          }
+        }
+      }
     }
-    else
+    return languages
+  }
+
+  /// The number of files each task of ``detectLanguages(for:readingContents:)`` classifies.
+  private static let batchChunkLength = 64
+
+  /// Every language keyed by its extensions (and special file names), the first language in ``allLanguages`` wins
+  /// when several claim the same one (e.g. `h`).
+  private static let languagesByExtension: [String: Editor.Code.Language] = allLanguages.reduce(into: [:])
+  { table, language in
+    for fileExtension in language.extensions where table[fileExtension] == nil
     {
-      .default
+      table[fileExtension] = language
     }
   }
 
@@ -67,104 +127,174 @@ public extension Editor.Code.Language
   /// - Returns: The detected code language, if any.
   private static func detectLanguageUsingURL(url: URL) -> Editor.Code.Language?
   {
-    let fileExtension = url.pathExtension.lowercased()
-    let fileName = url.pathComponents.last // should not be lowercase since it has to match e.g. `Dockerfile`
-    // This is to handle special file types without an extension (e.g., Makefile, Dockerfile)
-    let fileNameOrExtension = fileExtension.isEmpty ? (fileName != nil ? fileName! : "") : fileExtension
-    if let lang = allLanguages.first(where: { lang in lang.extensions.contains(fileNameOrExtension) })
+    let fileExtension = url.pathExtension
+    // This is to handle special file types without an extension (e.g., Makefile, Dockerfile), the file name should
+    // not be lowercased since it has to match e.g. `Dockerfile`
+    if fileExtension.isEmpty
     {
-      return lang
+      return languagesByExtension[url.lastPathComponent]
     }
-    else
+    return languagesByExtension[fileExtension.lowercased()]
+  }
+}
+
+/// Detects code languages from the contents of a document, scanning its UTF-8 bytes.
+///
+/// Patterns are matched ASCII case-insensitively in place, so the document is never lowercased or decoded, and
+/// identifiers are resolved with a single table lookup.
+private enum ContentSniffer
+{
+  typealias Bytes = UnsafeBufferPointer<UInt8>
+
+  /// The most bytes read from each end of a file.
+  static let readLength = 1024
+
+  /// The number of lines searched at each end of a file.
+  static let lineCount = 5
+
+  /// Every language keyed by its name, extensions and additional identifiers, the first language in
+  /// ``Editor/Code/Language/allLanguages`` wins when several claim the same one.
+  static let languagesByIdentifier: [String: Editor.Code.Language] =
+  {
+    var table: [String: Editor.Code.Language] = [:]
+    for language in Editor.Code.Language.allLanguages
     {
-      return nil
+      for identifier in [language.tsName] + language.extensions + language.additionalIdentifiers
+        where table[identifier] == nil
+      {
+        table[identifier] = language
+      }
+    }
+    return table
+  }()
+
+  static let shebang = Array("#!".utf8)
+  static let env = Array("env".utf8)
+  static let emacsDelimiter = Array("-*-".utf8)
+  static let emacsMode = Array("mode:".utf8)
+  static let vimMarker = Array("vim:".utf8)
+  static let vimFileType = Array("ft=".utf8)
+
+  /// Detects a language from the shebang of `prefix`, or a modeline in either `prefix` or `suffix`.
+  static func language(prefix: Bytes, suffix: Bytes) -> Editor.Code.Language?
+  {
+    shebangLanguage(in: prefix) ?? modelineLanguage(in: prefix) ?? modelineLanguage(in: suffix)
+  }
+
+  /// Detects a language from the first and last few lines of the file at `url`.
+  ///
+  /// At most ``readLength`` bytes are read from each end of the file, files that look binary are skipped.
+  static func language(contentsOf url: URL) -> Editor.Code.Language?
+  {
+    let descriptor = open(url.path, O_RDONLY)
+    guard descriptor >= 0 else { return nil }
+    defer { close(descriptor) }
+    var info = stat()
+    guard fstat(descriptor, &info) == 0, info.st_size > 0 else { return nil }
+    let size = Int(info.st_size)
+    let length = min(size, readLength)
+
+    return withUnsafeTemporaryAllocation(of: UInt8.self, capacity: 2 * readLength)
+    { buffer in
+      guard let base = buffer.baseAddress,
+            pread(descriptor, base, length, 0) == length,
+            memchr(base, 0, length) == nil
+      else
+      {
+        return nil
+      }
+      let head = Bytes(start: base, count: length)
+      guard size > length
+      else
+      {
+        return language(prefix: firstLines(of: head), suffix: lastLines(of: head))
+      }
+      guard pread(descriptor, base + readLength, length, off_t(size - length)) == length else { return nil }
+      let tail = Bytes(start: base + readLength, count: length)
+      return language(prefix: firstLines(of: head), suffix: lastLines(of: tail))
     }
   }
 
   /// Detects code langauges from the shebang of a file.
   /// Eg: `#!/usr/bin/env/python2.6` will detect the `python` code language.
   /// Or, `#! /usr/bin/env perl` will detect the `perl` code language.
-  /// - Parameter contents: The contents of the first few lines of the file.
+  /// - Parameter bytes: The contents of the first few lines of the file.
   /// - Returns: The detected code language, if any.
-  private static func detectLanguageUsingShebang(contents: String) -> Editor.Code.Language?
+  static func shebangLanguage(in bytes: Bytes) -> Editor.Code.Language?
   {
-    var contents = String(contents.split(separator: "\n").first ?? "")
+    var start = 0
+    while start < bytes.count, isLineBreak(bytes[start])
+    {
+      start += 1
+    }
+    let end = endOfLine(in: bytes, from: start)
     // Make sure:
     // - First line is a shebang
     // - There are contents after the shebang
     // - There is a valid script component (eg: "swift" in "/usr/env/swift")
-    guard
-      contents.starts(with: "#!"),
-      contents.trimmingCharacters(in: .whitespacesAndNewlines) != "#!",
-      let result = contents
-      .split(separator: "/", omittingEmptySubsequences: true)
-      .last?
-      .firstMatch(of: Regex { OneOrMore(.word) })
+    var componentEnd = end
+    while componentEnd > start, bytes[componentEnd - 1] == .slash
+    {
+      componentEnd -= 1
+    }
+    var componentStart = componentEnd
+    while componentStart > start, bytes[componentStart - 1] != .slash
+    {
+      componentStart -= 1
+    }
+    guard matches(shebang, in: bytes, at: start, before: end),
+          skipWhitespace(in: bytes, from: start + shebang.count, to: end) < end,
+          var script = firstWord(in: bytes, from: componentStart, to: componentEnd)
     else
     {
       return nil
     }
 
-    var script = result.output.trimmingCharacters(in: .whitespacesAndNewlines)
-
     // If script is "env" walk the string until we find a valid-looking script component
-    if script == "env"
+    if script.count == env.count, matches(env, in: bytes, at: script.lowerBound, before: end)
     {
       // If env is the end of the string, return
-      guard result.endIndex != contents.endIndex else { return nil }
-
-      let argumentRegex = Regex
-      {
-        ZeroOrMore(.whitespace)
-        ChoiceOf
-        {
-          One("-")
-          One("--")
-        }
-        ZeroOrMore(.word)
-        ZeroOrMore(.whitespace)
-      }
-      let parameterRegex = Regex
-      {
-        OneOrMore(.word)
-        One("=")
-        OneOrMore(.word)
-      }
+      guard script.upperBound != end else { return nil }
 
       // Skip over any optional arguments or parameters (eg: -x or x=y) and make script the next valid string
       // https://www.gnu.org/software/coreutils/manual/html_node/env-invocation.html
       // Skip first shebang-path string
-      contents.trimPrefix(Regex
+      var idx = start
+      var path = start
+      while matches(shebang, in: bytes, at: path, before: end)
       {
-        OneOrMore("#!")
-        ZeroOrMore(.whitespace)
-        OneOrMore(.any, .reluctant)
-        OneOrMore(.whitespace)
-      })
-      while !contents.isEmpty
+        path += shebang.count
+      }
+      path = skipWhitespace(in: bytes, from: path, to: end)
+      if let pathEnd = (path + 1 ..< max(path + 1, end)).first(where: { isWhitespace(bytes[$0]) })
       {
-        if contents.prefixMatch(of: argumentRegex) != nil
-        {
-          contents.trimPrefix(argumentRegex)
-        }
-        else if contents.prefixMatch(of: parameterRegex) != nil
+        idx = skipWhitespace(in: bytes, from: pathEnd, to: end)
+      }
+      while idx < end
+      {
+        let argument = skipWhitespace(in: bytes, from: idx, to: end)
+        if argument < end, bytes[argument] == .hyphen
         {
-          contents.trimPrefix(parameterRegex)
+          idx = skipWhitespace(in: bytes, from: skipWord(in: bytes, from: argument + 1, to: end), to: end)
+          continue
         }
-        else
+        let equals = skipWord(in: bytes, from: idx, to: end)
+        if equals > idx, equals < end, bytes[equals] == .equals
         {
-          break
+          let valueEnd = skipWord(in: bytes, from: equals + 1, to: end)
+          if valueEnd > equals + 1
+          {
+            idx = valueEnd
+            continue
+          }
         }
+        break
       }
-      guard let newScript = contents.firstMatch(of: Regex { OneOrMore(.word) })?.output
-      else
-      {
-        return nil
-      }
-      script = String(newScript)
+      guard let newScript = firstWord(in: bytes, from: idx, to: end) else { return nil }
+      script = newScript
     }
 
-    return languageFromIdentifier(script)
+    return language(named: script, in: bytes)
   }
 
   /// Detects modelines in either the beginning or end of a file.
@@ -178,90 +308,233 @@ public extension Editor.Code.Language
   /// ```
   /// All of the above would resolve to `javascript`
   ///
-  /// - Parameters:
-  ///   - prefixBuffer: The first few lines of a document.
-  ///   - suffixBuffer: The last few lines of a document.
+  /// - Parameter bytes: The first or last few lines of a document.
   /// - Returns: The detected code language, if any.
-  private static func detecLanguageUsingModeline(prefixBuffer: String, suffixBuffer: String?) -> Editor.Code.Language?
+  static func modelineLanguage(in bytes: Bytes) -> Editor.Code.Language?
   {
-    func detectModeline(in string: String) -> Editor.Code.Language?
+    if let mode = emacsModelineLanguage(in: bytes)
+    {
+      language(named: mode, in: bytes)
+    }
+    else if let fileType = vimModelineLanguage(in: bytes)
+    {
+      language(named: fileType, in: bytes)
+    }
+    else
     {
-      guard !string.isEmpty else { return nil }
+      nil
+    }
+  }
 
-      // Regex for detecting emacs modelines.
-      let emacsLineRegex = Regex
+  /// Finds the `mode:` parameter of the first emacs modeline (`-*- ... -*-`) in `bytes`.
+  static func emacsModelineLanguage(in bytes: Bytes) -> Range<Int>?
+  {
+    var lineStart = 0
+    while lineStart < bytes.count
+    {
+      let lineEnd = endOfLine(in: bytes, from: lineStart)
+      if let open = find(emacsDelimiter, in: bytes, from: lineStart, to: lineEnd),
+         let close = findLast(emacsDelimiter, in: bytes, from: open + emacsDelimiter.count, to: lineEnd)
       {
-        "-*-"
-        Capture
+        var from = open + emacsDelimiter.count
+        while let mode = find(emacsMode, in: bytes, from: from, to: close)
         {
-          #/.*/#
+          let valueStart = skipWhitespace(in: bytes, from: mode + emacsMode.count, to: close)
+          let valueEnd = skipWord(in: bytes, from: valueStart, to: close)
+          if valueEnd > valueStart
+          {
+            return valueStart ..< valueEnd
+          }
+          from = mode + 1
         }
-        "-*-"
+        return nil
       }
+      lineStart = lineEnd + 1
+    }
+    return nil
+  }
 
-      // Regex to find language parameters in a emacs modeline.
-      let emacsLanguageRegex = Regex
-      {
-        "mode:"
-        ZeroOrMore(.whitespace)
-        Capture
-        {
-          OneOrMore(.word)
-        }
-      }
+  /// Finds the `ft=` parameter of the first vim modeline (`// vim: ...` or `/* vim: ...`) in `bytes`.
+  static func vimModelineLanguage(in bytes: Bytes) -> Range<Int>?
+  {
+    var idx = 0
+    while idx + 1 < bytes.count
+    {
+      defer { idx += 1 }
+      guard bytes[idx] == .slash, bytes[idx + 1] == .slash || bytes[idx + 1] == .asterisk else { continue }
+      let marker = skipWhitespace(in: bytes, from: idx + 2, to: bytes.count)
+      guard marker > idx + 2, matches(vimMarker, in: bytes, at: marker, before: bytes.count) else { continue }
 
-      // Regex for detecting vim modelines.
-      let vimLineRegex = Regex
+      let lineEnd = endOfLine(in: bytes, from: marker)
+      var from = marker + vimMarker.count
+      while let fileType = find(vimFileType, in: bytes, from: from, to: lineEnd)
       {
-        ChoiceOf
+        let valueStart = fileType + vimFileType.count
+        let valueEnd = skipWord(in: bytes, from: valueStart, to: lineEnd)
+        if valueEnd > valueStart
         {
-          One("//")
-          One("/*")
+          return valueStart ..< valueEnd
         }
-        OneOrMore(.whitespace)
-        #/vim:.*/#
-        Optionally(.newlineSequence)
+        from = fileType + 1
       }
+      return nil
+    }
+    return nil
+  }
 
-      // Regex to find language parameters in a vim modeline.
-      let vimLanguageRegex = Regex
+  /// Finds a language to match a parsed identifier.
+  /// - Parameters:
+  ///   - range: The range of the identifier in `bytes`.
+  ///   - bytes: The bytes containing the identifier.
+  /// - Returns: The found code language, if any.
+  static func language(named range: Range<Int>, in bytes: Bytes) -> Editor.Code.Language?
+  {
+    let identifier = String(unsafeUninitializedCapacity: range.count)
+    { buffer in
+      for (offset, idx) in range.enumerated()
       {
-        "ft="
-        Capture
-        {
-          OneOrMore(.word)
-        }
+        buffer[offset] = lowercased(bytes[idx])
       }
+      return range.count
+    }
+    return languagesByIdentifier[identifier]
+  }
 
-      if let emacsLine = string.firstMatch(of: emacsLineRegex)?.1,
-         let emacsLanguage = emacsLine.firstMatch(of: emacsLanguageRegex)?.1
-      {
-        return languageFromIdentifier(String(emacsLanguage))
-      }
-      else if let vimLine = string.firstMatch(of: vimLineRegex)?.0,
-              let vimLanguage = vimLine.firstMatch(of: vimLanguageRegex)?.1
+  /// The first ``lineCount`` lines of `bytes`.
+  static func firstLines(of bytes: Bytes) -> Bytes
+  {
+    var lines = 0
+    for idx in bytes.indices where bytes[idx] == .newline
+    {
+      lines += 1
+      if lines == lineCount
       {
-        return languageFromIdentifier(String(vimLanguage))
+        return Bytes(rebasing: bytes[..<idx])
       }
-      else
+    }
+    return bytes
+  }
+
+  /// The last ``lineCount`` lines of `bytes`, not counting a trailing line break.
+  static func lastLines(of bytes: Bytes) -> Bytes
+  {
+    var lines = 0
+    for idx in bytes.indices.dropLast().reversed() where bytes[idx] == .newline
+    {
+      lines += 1
+      if lines == lineCount
       {
-        return nil
+        return Bytes(rebasing: bytes[(idx + 1)...])
       }
     }
+    return bytes
+  }
+
+  // MARK: - Scanning
+
+  /// Whether `literal`, which must be lowercase, starts at `idx` ignoring ASCII case.
+  static func matches(_ literal: [UInt8], in bytes: Bytes, at idx: Int, before end: Int) -> Bool
+  {
+    guard idx + literal.count <= end else { return false }
+    for offset in literal.indices where lowercased(bytes[idx + offset]) != literal[offset]
+    {
+      return false
+    }
+    return true
+  }
 
-    return detectModeline(in: prefixBuffer) ?? detectModeline(in: suffixBuffer ?? "")
+  /// The first location of `literal` within `from ..< to`.
+  static func find(_ literal: [UInt8], in bytes: Bytes, from: Int, to: Int) -> Int?
+  {
+    guard from <= to - literal.count else { return nil }
+    return (from ... to - literal.count).first { matches(literal, in: bytes, at: $0, before: to) }
   }
 
-  /// Finds a language to match a parsed identifier.
-  /// - Parameter identifier: The identifier to use.
-  /// - Returns: The found code language, if any.
-  private static func languageFromIdentifier(_ identifier: String) -> Editor.Code.Language?
+  /// The last location of `literal` within `from ..< to`.
+  static func findLast(_ literal: [UInt8], in bytes: Bytes, from: Int, to: Int) -> Int?
+  {
+    guard from <= to - literal.count else { return nil }
+    return (from ... to - literal.count).reversed().first { matches(literal, in: bytes, at: $0, before: to) }
+  }
+
+  /// The first run of word characters within `from ..< to`.
+  static func firstWord(in bytes: Bytes, from: Int, to: Int) -> Range<Int>?
+  {
+    guard let start = (from ..< max(from, to)).first(where: { isWord(bytes[$0]) }) else { return nil }
+    return start ..< skipWord(in: bytes, from: start, to: to)
+  }
+
+  /// The location of the first byte at or after `from` that isn't a word character.
+  static func skipWord(in bytes: Bytes, from: Int, to: Int) -> Int
+  {
+    var idx = from
+    while idx < to, isWord(bytes[idx])
+    {
+      idx += 1
+    }
+    return idx
+  }
+
+  /// The location of the first byte at or after `from` that isn't whitespace.
+  static func skipWhitespace(in bytes: Bytes, from: Int, to: Int) -> Int
   {
-    allLanguages.first
+    var idx = from
+    while idx < to, isWhitespace(bytes[idx])
     {
-      $0.tsName == identifier
-        || $0.extensions.contains(identifier)
-        || $0.additionalIdentifiers.contains(identifier)
+      idx += 1
     }
+    return idx
   }
+
+  /// The location of the line break ending the line containing `from`, or `bytes.count`.
+  static func endOfLine(in bytes: Bytes, from: Int) -> Int
+  {
+    var idx = from
+    while idx < bytes.count, !isLineBreak(bytes[idx])
+    {
+      idx += 1
+    }
+    return idx
+  }
+
+  static func isLineBreak(_ byte: UInt8) -> Bool
+  {
+    byte == .newline || byte == .carriageReturn
+  }
+
+  static func isWhitespace(_ byte: UInt8) -> Bool
+  {
+    byte == .space || (UInt8.tab ... UInt8.carriageReturn).contains(byte)
+  }
+
+  /// Letters, digits and underscores, bytes of multi-byte scalars are counted too since they're mostly letters.
+  static func isWord(_ byte: UInt8) -> Bool
+  {
+    byte >= 0x80 || byte == .underscore || (UInt8.digitZero ... UInt8.digitNine).contains(byte)
+      || (UInt8.lowercaseA ... UInt8.lowercaseZ).contains(byte | 0x20)
+  }
+
+  static func lowercased(_ byte: UInt8) -> UInt8
+  {
+    (UInt8.uppercaseA ... UInt8.uppercaseZ).contains(byte) ? byte | 0x20 : byte
+  }
+}
+
+private extension UInt8
+{
+  static let tab = UInt8(ascii: "\t")
+  static let newline = UInt8(ascii: "\n")
+  static let carriageReturn = UInt8(ascii: "\r")
+  static let space = UInt8(ascii: " ")
+  static let asterisk = UInt8(ascii: "*")
+  static let hyphen = UInt8(ascii: "-")
+  static let slash = UInt8(ascii: "/")
+  static let digitZero = UInt8(ascii: "0")
+  static let digitNine = UInt8(ascii: "9")
+  static let equals = UInt8(ascii: "=")
+  static let uppercaseA = UInt8(ascii: "A")
+  static let uppercaseZ = UInt8(ascii: "Z")
+  static let underscore = UInt8(ascii: "_")
+  static let lowercaseA = UInt8(ascii: "a")
+  static let lowercaseZ = UInt8(ascii: "z")
 }
@@ -24,7 +24,11 @@
  *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
  * -------------------------------------------------------------- */
 
-import OSLog
+import Foundation
+
+#if canImport(OSLog)
+  import OSLog
+#endif
 
 public enum Editor
 {
@@ -33,3 +37,18 @@ public enum Editor
     static let logger: Logger = .init(subsystem: "foundation.wabi.editors", category: "Code")
   }
 }
+
+#if !canImport(OSLog)
+  /// A minimal stand-in for `os.Logger` on platforms without unified logging (Linux),
+  /// so the language definitions can be built and tested headless.
+  struct Logger
+  {
+    let subsystem: String
+    let category: String
+
+    func warning(_ message: String)
+    {
+      FileHandle.standardError.write(Data("[\(subsystem).\(category)] warning: \(message)\n".utf8))
+    }
+  }
+#endif
@@ -24,6 +24,7 @@
  *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
  * -------------------------------------------------------------- */
 
+import CodeView
 import CxxStdlib
 import Foundation
 import PixarUSD
@@ -179,6 +180,23 @@ public extension Kraken.IO
       return tmpDir.appendingPathComponent("config/userpref.usd")
     }
 
+    /**
+     * The location of the autosave journal for a document.
+     *
+     * Journals live in the app support directory, named after
+     * the document's path so each document finds its journal
+     * again on relaunch.
+     *
+     * - Parameter fileURL: The document's file url. */
+    public func getJournalURL(for fileURL: URL) -> URL?
+    {
+      /* a stable hash, swift's own hasher is seeded per launch. */
+      let hash = EditJournal.fingerprint(of: fileURL.standardizedFileURL.path)
+      let name = "\(fileURL.lastPathComponent)-\(String(hash, radix: 16)).krj"
+
+      return getAppSupportDirectory(for: .kraken)?.appendingPathComponent("journals/\(name)")
+    }
+
     public func getStartupURL() -> URL
     {
       tmpDir.appending(component: "Startup.usd")
@@ -0,0 +1,283 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CosmoEditor
+import Foundation
+import PixarUSD
+
+public extension Kraken.IO.USD
+{
+  /**
+   * The syntax tree nodes that edits to usda text are
+   * narrowed down to, see ``specEdits(for:in:)``. */
+  static let specNodeTypes: Set<String> = [
+    "prim_definition",
+    "attribute_assignment",
+    "variant_set_definition"
+  ]
+
+  /**
+   * Whether the code editor copies its edits onto the stage
+   * spec by spec, see ``Context/apply(_:)``. The Sdf calls it
+   * uses haven't been built against SwiftUSD yet, so it's only
+   * enabled with `KRAKEN_EXPERIMENTAL_USD` defined, and without
+   * it, the code editor saves the stage as it always has. */
+  #if KRAKEN_EXPERIMENTAL_USD
+    static let syncsSpecs = true
+  #else /* !KRAKEN_EXPERIMENTAL_USD */
+    static let syncsSpecs = false
+  #endif /* KRAKEN_EXPERIMENTAL_USD */
+
+  /**
+   * An edit to the text of a usd layer, narrowed down to
+   * the single prim or attribute spec that it changed. */
+  struct SpecEdit: Hashable
+  {
+    /** the path of the changed spec, a prim or property path. */
+    public let path: String
+
+    /** the path of the prim holding the spec, which has to
+     * exist before the spec can be copied beneath it. */
+    public let parentPath: String
+
+    /** a usda layer holding only the changed spec, nested in
+     * empty overs of each of its ancestors. */
+    public let layer: String
+  }
+
+  /**
+   * Narrows edits to usda text down to the specs they changed.
+   *
+   * An edit within the value of an attribute only changes
+   * that attribute, any other edit changes the innermost prim
+   * around it. Edits to the name of a prim or attribute move
+   * up to the parent prim, as the spec under the old name has
+   * to go too, and so do edits within a variant set.
+   *
+   * - Parameters:
+   *   - edits: the edited ranges of the text, each with the
+   *     ``specNodeTypes`` nodes around it, outermost first.
+   *   - text: the edited text.
+   * - Returns: the changed specs, leaving out any within one
+   *   of the others, or `nil` if an edit was outside of every
+   *   prim and the whole layer has to be reloaded. */
+  static func specEdits(
+    for edits: [(range: NSRange, nodes: [TreeSitterClient.SyntaxNode])],
+    in text: NSString
+  ) -> [SpecEdit]?
+  {
+    var specEdits = Set<SpecEdit>()
+    for (range, nodes) in edits
+    {
+      /* nothing within a variant set maps onto a plain path. */
+      let nodes = Array(nodes.prefix { $0.type != "variant_set_definition" })
+      guard let specEdit = specEdit(for: range, nodes: nodes, in: text)
+      else { return nil }
+
+      specEdits.insert(specEdit)
+    }
+
+    let paths = specEdits.map(\.path)
+    return specEdits
+      .filter
+      { edit in
+        !paths.contains { edit.path.hasPrefix($0 + "/") || edit.path.hasPrefix($0 + ".") }
+      }
+      .sorted { $0.path < $1.path }
+  }
+
+  /**
+   * Finds the spec changed by an edit of the given range. */
+  private static func specEdit(
+    for range: NSRange,
+    nodes: [TreeSitterClient.SyntaxNode],
+    in text: NSString
+  ) -> SpecEdit?
+  {
+    var prims = nodes
+    if let attribute = prims.last, attribute.type == "attribute_assignment"
+    {
+      prims.removeLast()
+
+      let assignment = text.range(of: "=", range: attribute.range)
+      if assignment.location != NSNotFound,
+         range.location > assignment.location,
+         let name = propertyName(
+           in: text.substring(with: NSRange(
+             location: attribute.range.location,
+             length: assignment.location - attribute.range.location
+           ))
+         ),
+         let primPath = path(of: prims, in: text)
+      {
+        return SpecEdit(
+          path: "\(primPath).\(name)",
+          parentPath: primPath,
+          layer: layer(wrapping: text.substring(with: attribute.range), in: prims, of: text)
+        )
+      }
+    }
+
+    while let prim = prims.last, prim.type != "prim_definition" || editsName(range, of: prim, in: text)
+    {
+      prims.removeLast()
+    }
+    guard let prim = prims.popLast(),
+          let primPath = path(of: prims + [prim], in: text)
+    else { return nil }
+
+    return SpecEdit(
+      path: primPath,
+      parentPath: path(of: prims, in: text) ?? "/",
+      layer: layer(wrapping: text.substring(with: prim.range), in: prims, of: text)
+    )
+  }
+
+  /**
+   * The range of a prim's name, the first quoted string of
+   * its definition, without the quotes. */
+  private static func nameRange(of prim: TreeSitterClient.SyntaxNode, in text: NSString) -> NSRange?
+  {
+    let open = text.range(of: "\"", range: prim.range)
+    guard open.location != NSNotFound else { return nil }
+
+    let rest = NSRange(location: NSMaxRange(open), length: NSMaxRange(prim.range) - NSMaxRange(open))
+    let close = text.range(of: "\"", range: rest)
+    guard close.location != NSNotFound else { return nil }
+
+    return NSRange(location: rest.location, length: close.location - rest.location)
+  }
+
+  /**
+   * Whether an edit touches the name of a prim. */
+  private static func editsName(_ range: NSRange, of prim: TreeSitterClient.SyntaxNode, in text: NSString) -> Bool
+  {
+    guard let name = nameRange(of: prim, in: text) else { return true }
+    return range.location <= NSMaxRange(name) && NSMaxRange(range) >= name.location
+  }
+
+  /**
+   * The path of the innermost of the nested prims. */
+  private static func path(of prims: [TreeSitterClient.SyntaxNode], in text: NSString) -> String?
+  {
+    guard !prims.isEmpty else { return nil }
+
+    var path = ""
+    for prim in prims
+    {
+      guard let name = nameRange(of: prim, in: text) else { return nil }
+      path += "/" + text.substring(with: name)
+    }
+    return path
+  }
+
+  /**
+   * The name of the property declared by the text before an
+   * attribute's `=`, e.g. `radius` in `double radius`. */
+  private static func propertyName(in declaration: String) -> String?
+  {
+    guard var name = declaration.split(whereSeparator: \.isWhitespace).last.map(String.init)
+    else { return nil }
+
+    for suffix in [".timeSamples", ".connect", ".spline"] where name.hasSuffix(suffix)
+    {
+      name.removeLast(suffix.count)
+    }
+    return name.isEmpty ? nil : name
+  }
+
+  /**
+   * A usda layer holding `body`, nested in empty overs of the
+   * given prims. */
+  private static func layer(wrapping body: String, in prims: [TreeSitterClient.SyntaxNode], of text: NSString) -> String
+  {
+    var layer = "#usda 1.0\n"
+    for prim in prims
+    {
+      let name = nameRange(of: prim, in: text).map { text.substring(with: $0) } ?? ""
+      layer += "over \"\(name)\"\n{\n"
+    }
+    layer += body + "\n"
+    layer += String(repeating: "}\n", count: prims.count)
+    return layer
+  }
+}
+
+public extension Kraken.IO.USD.Context
+{
+  /**
+   * Applies edits made to the text of the context to the
+   * kraken stage.
+   *
+   * Each changed spec is imported from a small layer of its
+   * own and copied over the spec in the stage's root layer,
+   * all within a single change block, which also authors the
+   * overs of its parents. Typing in a large layer therefore
+   * only recomposes what was typed, rather than reloading the
+   * whole stage.
+   *
+   * The spec by spec path is only compiled with
+   * `KRAKEN_EXPERIMENTAL_USD` defined, see ``Kraken/IO/USD/syncsSpecs``.
+   * Without it, every edit reloads the whole stage.
+   *
+   * - Parameter edits: the changed specs, or `nil` to reload
+   *   the whole stage. */
+  func apply(_ edits: [Kraken.IO.USD.SpecEdit]?)
+  {
+    stageRevision += 1
+
+    #if KRAKEN_EXPERIMENTAL_USD
+      guard let edits
+      else
+      {
+        loadAndSave()
+        return
+      }
+
+      let rootLayer = krakenStage.getRootLayer()
+      let changes = Sdf.ChangeBlock()
+      for edit in edits
+      {
+        /* parents are authored in the layer too, as overs, since
+         * the stage mustn't be edited within a change block. */
+        if edit.parentPath != "/"
+        {
+          Sdf.createPrimInLayer(rootLayer, Sdf.Path(edit.parentPath))
+        }
+
+        let layer = Sdf.Layer.createAnonymous()
+        guard layer.importFromString(edit.layer)
+        else { continue }
+
+        Sdf.copySpec(layer, Sdf.Path(edit.path), rootLayer, Sdf.Path(edit.path))
+      }
+      withExtendedLifetime(changes) {}
+    #else /* !KRAKEN_EXPERIMENTAL_USD */
+      _ = edits
+      loadAndSave()
+    #endif /* KRAKEN_EXPERIMENTAL_USD */
+  }
+}
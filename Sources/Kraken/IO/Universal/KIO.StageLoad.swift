@@ -0,0 +1,131 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+
+import Foundation
+import PixarUSD
+
+public extension Kraken.IO.USD
+{
+  /** the path the opened file is referenced in at, on the kraken stage. */
+  static let scenePath = "/Kraken/Scene"
+}
+
+public extension Kraken.IO.USD.Context
+{
+  /**
+   * Opens the usd file at the given url, and references it
+   * into the kraken stage as its scene.
+   *
+   * The file's own stage is opened, given a default prim and
+   * saved in the background, so a large file doesn't hold up
+   * the interface. Only referencing it into the kraken stage
+   * happens on the main thread. Opening another file cancels
+   * this one.
+   *
+   * - Parameter fileURL: the usd file to open.
+   * - Returns: the progress of opening the file, which also
+   *   remains in ``openProgress`` until it is done, and which
+   *   can be cancelled until the scene is referenced in. */
+  @discardableResult
+  func open(fileURL: URL) -> Progress
+  {
+    openProgress?.cancel()
+
+    let progress = Progress(totalUnitCount: 3)
+    openProgress = progress
+
+    let task = Task.detached(priority: .userInitiated)
+    {
+      let stage = Self.prepareStage(at: fileURL, progress: progress)
+
+      await MainActor.run
+      {
+        if let stage, !progress.isCancelled
+        {
+          self.adopt(stage, fileURL: fileURL)
+          progress.completedUnitCount = 3
+        }
+        if self.openProgress === progress
+        {
+          self.openProgress = nil
+        }
+      }
+    }
+    progress.cancellationHandler = { task.cancel() }
+
+    return progress
+  }
+
+  /**
+   * Loads and saves the kraken stage. */
+  func loadAndSave()
+  {
+    stageRevision += 1
+
+    Kraken.IO.Stage.manager.loadAndSave(stage: &krakenStage)
+  }
+}
+
+extension Kraken.IO.USD.Context
+{
+  /**
+   * Opens the stage of a file, and gives it a default prim
+   * so it can be referenced. Runs in the background, and
+   * returns `nil` once the open is cancelled. */
+  private static func prepareStage(at fileURL: URL, progress: Progress) -> UsdStageRefPtr?
+  {
+    var stage = Usd.Stage.open(fileURL.path)
+    progress.completedUnitCount = 1
+    guard !Task.isCancelled else { return nil }
+
+    for prim in stage.traverse() {
+      stage.setDefaultPrim(prim)
+      break
+    }
+    Kraken.IO.Stage.manager.save(&stage)
+    progress.completedUnitCount = 2
+    guard !Task.isCancelled else { return nil }
+
+    return stage
+  }
+
+  /**
+   * Makes an opened stage the one of this context, and
+   * references it into the kraken stage as its scene. */
+  private func adopt(_ stage: UsdStageRefPtr, fileURL: URL)
+  {
+    self.fileURL = fileURL
+    self.stage = stage
+
+    // reference in the usd project file as a kraken scene.
+    var sceneRef = krakenStage.overridePrim(path: Kraken.IO.USD.scenePath).getReferences()
+    sceneRef.addReference(assetPath: fileURL.path)
+    loadAndSave()
+
+    usda = openJournal(onto: exportStage())
+  }
+}
@@ -25,7 +25,9 @@
  * -------------------------------------------------------------- */
 
 import CodeLanguages
+import CodeView
 import CosmoEditor
+import KrakenLib
 import PixarUSD
 import SwiftUI
 import UniformTypeIdentifiers
@@ -78,11 +80,8 @@ public extension Kraken.IO
             let string = String(data: data, encoding: .utf8)
       else
       {
-        Kraken.IO.Stage.manager.loadAndSave(stage: &context.krakenStage)
-
-        var contents = ""
-        context.krakenStage.exportToString(&contents, addSourceFileComment: false)
-        context.usda = String(contents.prefix(Kraken.IO.TREE_SITTER_MAX))
+        context.loadAndSave()
+        context.syncFromStage()
         return
       }
       context.usda = String(string.prefix(Kraken.IO.TREE_SITTER_MAX))
@@ -90,9 +89,10 @@ public extension Kraken.IO
 
     public func fileWrapper(snapshot _: Kraken.IO.USD.Context, configuration _: WriteConfiguration) throws -> FileWrapper
     {
-      var contents = ""
-      context.krakenStage.exportToString(&contents, addSourceFileComment: false)
-      context.usda = String(contents.prefix(Kraken.IO.TREE_SITTER_MAX))
+      context.syncFromStage()
+
+      /* the saved text is the new baseline for crash recovery. */
+      context.journal?.reset(baseline: context.usda)
 
       return .init(regularFileWithContents: context.usda.data(using: .utf8)!)
     }
@@ -125,6 +125,27 @@ public extension Kraken.IO.USD
     public var krakenStage: UsdStageRefPtr
     public var stage: UsdStageRefPtr
 
+    /** the autosave journal of unsaved edits to the text. */
+    @ObservationIgnored public private(set) var journal: EditJournal?
+
+    /** the code editor's undo manager, which also feeds the journal. */
+    @ObservationIgnored public let undoManager = CEUndoManager()
+
+    /** identifies the document whose text is shown, so the code
+     * editor reloads a new document rather than diffing it. */
+    public private(set) var documentID = UUID()
+
+    /** counts the changes made to the kraken stage, so it is
+     * only exported again once it has changed. */
+    @ObservationIgnored var stageRevision = 0
+
+    /** the revision of the kraken stage the text was last
+     * exported from. */
+    @ObservationIgnored var exportedRevision: Int?
+
+    /** the progress of opening a file, while one is being opened. */
+    public internal(set) var openProgress: Progress?
+
     public var id: String
     {
       fileURL.path
@@ -151,35 +172,82 @@ public extension Kraken.IO.USD
       Kraken.IO.Stage.manager.save(&stage)
 
       // reference in the usd project file as a kraken scene.
-      var sceneRef = krakenStage.overridePrim(path: "/Kraken/Scene").getReferences()
+      var sceneRef = krakenStage.overridePrim(path: Kraken.IO.USD.scenePath).getReferences()
       sceneRef.addReference(assetPath: fileURL.path)
-      Kraken.IO.Stage.manager.loadAndSave(stage: &krakenStage)
+      loadAndSave()
 
-      var contents = ""
-      krakenStage.exportToString(&contents, addSourceFileComment: false)
-      usda = String(contents.prefix(Kraken.IO.TREE_SITTER_MAX))
+      usda = openJournal(onto: exportStage())
     }
+  }
+}
 
-    public func open(fileURL: URL)
+public extension Kraken.IO.USD.Context
+{
+  /**
+   * Brings the text of the context up to date with the
+   * kraken stage.
+   *
+   * The stage is only exported when it has changed since the
+   * text was last exported from it, and the text is only
+   * assigned when the export differs. The code editor applies
+   * a new text as edits to the lines that changed instead of
+   * reloading, so its line storage and syntax tree survive
+   * changes made to the stage programmatically, and those
+   * edits can be undone and are journaled like typed ones.
+   *
+   * The export itself still covers the whole stage, there is
+   * no change notice listener narrowing it down to the prims
+   * that changed. */
+  func syncFromStage()
+  {
+    guard exportedRevision != stageRevision else { return }
+
+    let text = exportStage()
+    if text != usda
     {
-      self.fileURL = fileURL
+      usda = text
+    }
+  }
 
-      stage = Usd.Stage.open(fileURL.path)
-      for prim in stage.traverse() {
-        stage.setDefaultPrim(prim)
-        break
-      }
-      Kraken.IO.Stage.manager.save(&stage)
+  /**
+   * The text of the kraken stage, as much of it as the code
+   * editor can show. */
+  func exportStage() -> String
+  {
+    exportedRevision = stageRevision
 
-      // reference in the usd project file as a kraken scene.
-      var sceneRef = krakenStage.overridePrim(path: "/Kraken/Scene").getReferences()
-      sceneRef.addReference(assetPath: fileURL.path)
-      Kraken.IO.Stage.manager.loadAndSave(stage: &krakenStage)
+    var contents = ""
+    krakenStage.exportToString(&contents, addSourceFileComment: false)
 
-      var contents = ""
-      krakenStage.exportToString(&contents, addSourceFileComment: false)
-      usda = String(contents.prefix(Kraken.IO.TREE_SITTER_MAX))
-    }
+    return String(contents.prefix(Kraken.IO.TREE_SITTER_MAX))
+  }
+}
+
+extension Kraken.IO.USD.Context
+{
+  /**
+   * Opens the autosave journal for the context's file url,
+   * recovering any edits left unsaved by a crash.
+   *
+   * Edits are replayed onto the text of the last save, so
+   * recovery costs as much as the edits themselves rather
+   * than a rewrite of the whole document. The undo manager
+   * records into the new journal straight away, with the
+   * history of the previous document cleared, so this must
+   * be called before the new text is assigned.
+   *
+   * - Parameter baseline: the text of the file as loaded.
+   * - Returns: the text to show, with any recovered edits. */
+  func openJournal(onto baseline: String) -> String
+  {
+    journal?.flush()
+    journal = Kraken.IO.Stage.manager.getJournalURL(for: fileURL).flatMap { EditJournal(url: $0) }
+    documentID = UUID()
+
+    undoManager.journal = journal
+    undoManager.clearStack()
+
+    return journal?.recover(onto: baseline) ?? baseline
   }
 }
 
@@ -196,13 +264,24 @@ public extension ReferenceFileDocumentConfiguration<Kraken.IO.USD>
    * The detected language of the document.
    *
    * Uses the document's file url to detect the
-   * language of the document (swift, usd, etc). */
+   * language of the document (swift, usd, etc),
+   * falling back to the first and last lines of
+   * the file, which are read without loading the
+   * rest of it. */
   var language: Editor.Code.Language
   {
     guard let url = fileURL
     else { return .default }
 
-    return .detectLanguageFrom(url: url)
+    let language = Editor.Code.Language.detectLanguageFrom(url: url)
+    guard language == .default, url.isFileURL
+    else { return language }
+
+    return .detectLanguageFrom(
+      url: url,
+      prefixBuffer: try? url.readFirstLines(5),
+      suffixBuffer: try? url.readLastLines(5)
+    )
   }
 }
 
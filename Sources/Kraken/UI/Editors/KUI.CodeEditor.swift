@@ -25,6 +25,7 @@
  * -------------------------------------------------------------- */
 
 import CodeLanguages
+import CodeView
 import CosmoEditor
 import Foundation
 import KrakenLib
@@ -52,6 +53,9 @@ public extension Kraken.UI
     /** default code editor cursor positions. */
     @State private var cursorPositions: [CursorPosition] = []
 
+    /** applies the edits made in the code editor to the context's stage. */
+    @State private var stageSync = StageSync()
+
     /* -------------------------------------------------------- */
 
     /** perisistent setting whether lines wrap to the editor's width. */
@@ -72,7 +76,10 @@ public extension Kraken.UI
           lineHeight: 1.2,
           wrapLines: wrapLines,
           cursorPositions: $cursorPositions,
-          useThemeBackground: false
+          useThemeBackground: false,
+          undoManager: C.context.undoManager,
+          documentID: C.context.documentID,
+          coordinators: Kraken.IO.USD.syncsSpecs ? [stageSync] : []
         )
 
         Divider()
@@ -84,6 +91,21 @@ public extension Kraken.UI
 
           Spacer()
 
+          if let openProgress = C.context.openProgress
+          {
+            ProgressView(openProgress)
+              .progressViewStyle(.linear)
+              .labelsHidden()
+              .frame(maxWidth: 120)
+
+            Button("Cancel", systemImage: "xmark.circle.fill")
+            {
+              openProgress.cancel()
+            }
+            .labelStyle(.iconOnly)
+            .buttonStyle(.plain)
+          }
+
           Text(C.context.fileURL.lastPathComponent)
             .font(.system(size: 8, weight: .bold, design: .monospaced))
             .padding(.trailing, 4)
@@ -97,14 +119,26 @@ public extension Kraken.UI
       }
       .onChange(of: C)
       {
+        /* spec by spec syncing saves the stage itself. */
+        guard !Kraken.IO.USD.syncsSpecs else { return }
+
         Task
         {
-          Kraken.IO.Stage.manager.loadAndSave(stage: &C.context.krakenStage)
+          C.context.loadAndSave()
         }
       }
+      .onChange(of: C.context.fileURL)
+      {
+        stageSync.context = C.context
+      }
       .onAppear
       {
         language = detectLanguage(fileURL: C.context.fileURL) ?? .default
+        stageSync.context = C.context
+      }
+      .onDisappear
+      {
+        C.context.journal?.flush()
       }
     }
 
@@ -117,8 +151,8 @@ public extension Kraken.UI
       guard let fileURL else { return nil }
       return Editor.Code.Language.detectLanguageFrom(
         url: fileURL,
-        prefixBuffer: C.context.usda.getFirstLines(5),
-        suffixBuffer: C.context.usda.getLastLines(5)
+        prefixBuffer: String(C.context.usda.firstLines(5)),
+        suffixBuffer: String(C.context.usda.lastLines(5))
       )
     }
 
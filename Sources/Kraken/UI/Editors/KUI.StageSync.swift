@@ -0,0 +1,176 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import AppKit
+import CodeView
+import CosmoEditor
+import Foundation
+import PixarUSD
+
+public extension Kraken.UI.CodeEditor
+{
+  /**
+   * Keeps the kraken stage in sync with edits made in the
+   * code editor, one changed spec at a time.
+   *
+   * Edited ranges are collected as they are typed, and once
+   * typing pauses, are narrowed down to the prims and
+   * attributes around them with the editor's syntax tree, see
+   * ``Kraken/IO/USD/specEdits(for:in:)``. Only those specs
+   * are copied onto the stage, the whole stage is reloaded
+   * only when an edit can't be narrowed down. The code editor
+   * only attaches it when ``Kraken/IO/USD/syncsSpecs`` is set. */
+  final class StageSync: NSObject, TextViewCoordinator, NSTextStorageDelegate
+  {
+    /** the context whose stage is kept in sync. */
+    public weak var context: Kraken.IO.USD.Context?
+
+    /** the controller of the code editor being edited. */
+    private weak var controller: TextViewController?
+
+    /** the ranges edited since the last sync, in the current text. */
+    private var editedRanges: [NSRange] = []
+
+    /** counts the edits, to tell whether any were made while
+     * a sync was looking up syntax nodes. */
+    private var generation = 0
+
+    /** the pending sync, pushed back by each edit. */
+    private var pendingSync: DispatchWorkItem?
+
+    /** how long typing has to pause before syncing. */
+    private let delay: TimeInterval = 0.25
+
+    public init(context: Kraken.IO.USD.Context? = nil)
+    {
+      self.context = context
+      super.init()
+    }
+
+    public func prepareCoordinator(controller: TextViewController)
+    {
+      self.controller = controller
+      controller.textView.addStorageDelegate(self)
+    }
+
+    public func textViewDidChangeText(controller _: TextViewController)
+    {
+      guard !editedRanges.isEmpty else { return }
+
+      pendingSync?.cancel()
+      let sync = DispatchWorkItem { [weak self] in self?.sync() }
+      pendingSync = sync
+      DispatchQueue.main.asyncAfter(deadline: .now() + delay, execute: sync)
+    }
+
+    public func destroy()
+    {
+      pendingSync?.cancel()
+      pendingSync = nil
+      controller?.textView?.removeStorageDelegate(self)
+      controller = nil
+    }
+
+    /**
+     * Records the range of each edit, moving the ranges of
+     * earlier edits after it and merging those it overlaps.
+     * Text applied by the editor itself came from the stage,
+     * so it only moves the other ranges. */
+    public func textStorage(
+      _: NSTextStorage,
+      didProcessEditing editedMask: NSTextStorageEditActions,
+      range editedRange: NSRange,
+      changeInLength delta: Int
+    )
+    {
+      guard editedMask.contains(.editedCharacters) else { return }
+
+      /* the edited range before the edit, to compare with. */
+      let start = editedRange.location
+      var end = NSMaxRange(editedRange) - delta
+      var location = start
+      var overlaps = false
+
+      editedRanges = editedRanges.compactMap
+      { range in
+        if NSMaxRange(range) < start
+        {
+          return range
+        }
+        if range.location > end
+        {
+          return NSRange(location: range.location + delta, length: range.length)
+        }
+        location = min(location, range.location)
+        end = max(end, NSMaxRange(range))
+        overlaps = true
+        return nil
+      }
+
+      if overlaps || controller?.isApplyingText != true
+      {
+        editedRanges.append(NSRange(location: location, length: end + delta - location))
+        editedRanges.sort { $0.location < $1.location }
+      }
+      generation += 1
+    }
+
+    /**
+     * Looks up the syntax nodes around the edited ranges, and
+     * applies the specs they changed to the stage, unless more
+     * edits were made in the meantime. */
+    private func sync()
+    {
+      pendingSync = nil
+      guard let controller, let context, !editedRanges.isEmpty else { return }
+
+      guard controller.language.id == .usd, let treeSitterClient = controller.treeSitterClient
+      else
+      {
+        editedRanges = []
+        context.apply(nil)
+        return
+      }
+
+      let ranges = editedRanges
+      let generation = generation
+      treeSitterClient.enclosingNodes(
+        of: ranges,
+        types: Kraken.IO.USD.specNodeTypes,
+        textView: controller.textView
+      )
+      { [weak self] nodes in
+        /* newer edits schedule a sync of their own. */
+        guard let self, self.generation == generation, let controller = self.controller else { return }
+
+        editedRanges = []
+        let text = controller.textView.textStorage.string as NSString
+        let edits = zip(ranges, nodes).map { (range: $0, nodes: $1) }
+        self.context?.apply(Kraken.IO.USD.specEdits(for: edits, in: text))
+      }
+    }
+  }
+}
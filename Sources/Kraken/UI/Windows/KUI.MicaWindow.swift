@@ -64,10 +64,8 @@ public extension Kraken.UI
         {
           if let url = file.fileURL
           {
-            Task
-            {
-              file.document.context.open(fileURL: url)
-            }
+            /* opens in the background, see the editor's status bar. */
+            file.document.context.open(fileURL: url)
           }
         }
       }
@@ -0,0 +1,88 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+public extension URL
+{
+  /// Reads the first `n` lines of the file at this url.
+  ///
+  /// Only the first `maxBytes` of the file are read, so the cost doesn't grow with the size of the file.
+  /// - Parameters:
+  ///   - lines: The number of lines to return.
+  ///   - maxBytes: The maximum number of bytes to read.
+  /// - Returns: A new string containing the lines.
+  func readFirstLines(_ lines: Int = 1, maxBytes: Int = 4096) throws -> String
+  {
+    let handle = try FileHandle(forReadingFrom: self)
+    defer { try? handle.close() }
+
+    let data = try handle.read(upToCount: maxBytes) ?? Data()
+    return String(String(decoding: data.droppingPartialScalar(), as: UTF8.self).firstLines(lines, maxLength: maxBytes))
+  }
+
+  /// Reads the last `n` lines of the file at this url.
+  ///
+  /// Seeks to the last `maxBytes` of the file and reads only those, so the cost doesn't grow with the size of the
+  /// file.
+  /// - Parameters:
+  ///   - lines: The number of lines to return.
+  ///   - maxBytes: The maximum number of bytes to read.
+  /// - Returns: A new string containing the lines.
+  func readLastLines(_ lines: Int = 1, maxBytes: Int = 4096) throws -> String
+  {
+    let handle = try FileHandle(forReadingFrom: self)
+    defer { try? handle.close() }
+
+    let size = try handle.seekToEnd()
+    let offset = size > UInt64(maxBytes) ? size - UInt64(maxBytes) : 0
+    try handle.seek(toOffset: offset)
+    var data = try handle.read(upToCount: maxBytes) ?? Data()
+    if offset > 0
+    {
+      // skip the rest of a character the seek landed in the middle of.
+      data = data.drop { $0 & 0xC0 == 0x80 }
+    }
+    return String(String(decoding: data, as: UTF8.self).lastLines(lines, maxLength: maxBytes))
+  }
+}
+
+private extension Data
+{
+  /// Drops a UTF-8 sequence that was cut off at the end of the data.
+  func droppingPartialScalar() -> Data
+  {
+    guard let lead = lastIndex(where: { $0 & 0xC0 != 0x80 }) else { return self }
+    let length = switch self[lead]
+    {
+      case ..<0x80: 1
+      case 0xF0...: 4
+      case 0xE0...: 3
+      default: 2
+    }
+    return endIndex - lead < length ? self[..<lead] : self
+  }
+}
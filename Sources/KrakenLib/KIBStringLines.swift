@@ -35,48 +35,75 @@ public extension String
   /// - Returns: A new string containing the lines.
   func getFirstLines(_ lines: Int = 1, maxLength: Int = 512) -> String
   {
-    var string = ""
+    String(firstLines(lines, maxLength: maxLength - 1))
+  }
+
+  /// Calculates the last `n` lines and returns them as a new string.
+  /// - Parameters:
+  ///   - lines: The number of lines to return.
+  ///   - maxLength: The maximum number of characters to copy.
+  /// - Returns: A new string containing the lines.
+  func getLastLines(_ lines: Int = 1, maxLength: Int = 512) -> String
+  {
+    String(lastLines(lines, maxLength: maxLength - 1))
+  }
+
+  /// The first `n` lines of the string, without the line break ending them.
+  ///
+  /// Walks forward from the start of the string and stops at the `n`th line break, so only the returned characters
+  /// are ever visited and nothing is copied.
+  /// - Parameters:
+  ///   - lines: The number of lines to return.
+  ///   - maxLength: The maximum number of characters to return.
+  /// - Returns: A substring of the lines.
+  func firstLines(_ lines: Int = 1, maxLength: Int = 512) -> Substring
+  {
+    var end = startIndex
     var foundLines = 0
-    var totalLength = 0
-    for char in lazy
+    var length = 0
+    while end != endIndex, length < maxLength
     {
-      if char.isNewline
+      if self[end].isNewline
       {
         foundLines += 1
       }
-      totalLength += 1
-      if foundLines >= lines || totalLength >= maxLength
+      if foundLines >= lines
       {
         break
       }
-      string.append(char)
+      formIndex(after: &end)
+      length += 1
     }
-    return string
+    return self[..<end]
   }
 
-  /// Calculates the last `n` lines and returns them as a new string.
+  /// The last `n` lines of the string, counting a trailing line break as the end of a line.
+  ///
+  /// Walks backward from the end of the string and stops at the `n`th line break, so only the returned characters
+  /// are ever visited and nothing is copied.
   /// - Parameters:
   ///   - lines: The number of lines to return.
-  ///   - maxLength: The maximum number of characters to copy.
-  /// - Returns: A new string containing the lines.
-  func getLastLines(_ lines: Int = 1, maxLength: Int = 512) -> String
+  ///   - maxLength: The maximum number of characters to return.
+  /// - Returns: A substring of the lines.
+  func lastLines(_ lines: Int = 1, maxLength: Int = 512) -> Substring
   {
-    var string = ""
+    var start = endIndex
     var foundLines = 0
-    var totalLength = 0
-    for char in lazy.reversed()
+    var length = 0
+    while start != startIndex, length < maxLength
     {
-      if char.isNewline
+      let previous = index(before: start)
+      if self[previous].isNewline
       {
         foundLines += 1
       }
-      totalLength += 1
-      if foundLines >= lines || totalLength >= maxLength
+      if foundLines >= lines
       {
         break
       }
-      string = String(char) + string
+      start = previous
+      length += 1
     }
-    return string
+    return self[start...]
   }
 }
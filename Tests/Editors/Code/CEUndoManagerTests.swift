@@ -0,0 +1,151 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+#if canImport(CodeView)
+  import TextStory
+  import XCTest
+  @testable import CodeView
+
+  final class CEUndoManagerTests: XCTestCase
+  {
+    typealias Edit = CEUndoManager.Edit
+
+    /// Applies the edits one after another, as an undo group would without batching.
+    func applySequentially(_ edits: [Edit], to text: String) -> String
+    {
+      let string = NSMutableString(string: text)
+      for edit in edits
+      {
+        string.replaceCharacters(in: edit.range, with: edit.string)
+      }
+      return string as String
+    }
+
+    /// Applies disjoint edits relative to the original text, back to front.
+    func applyBatch(_ edits: [Edit], to text: String) -> String
+    {
+      let string = NSMutableString(string: text)
+      for edit in edits.reversed()
+      {
+        string.replaceCharacters(in: edit.range, with: edit.string)
+      }
+      return string as String
+    }
+
+    func edit(_ location: Int, _ length: Int, _ string: String) -> Edit
+    {
+      Edit(range: NSRange(location: location, length: length), string: string, length: (string as NSString).length)
+    }
+
+    func test_batchesTyping()
+    {
+      let edits = [edit(3, 0, "a"), edit(4, 0, "b"), edit(5, 0, "c")]
+      let batch = CEUndoManager.batch(edits)
+      XCTAssertEqual(batch?.count, 1)
+      XCTAssertEqual(batch?.first?.string, "abc")
+      XCTAssertEqual(batch?.first?.range, NSRange(location: 3, length: 0))
+    }
+
+    func test_batchesDeleting()
+    {
+      let text = "let value = 10"
+      let backspaces = [edit(5, 1, ""), edit(4, 1, ""), edit(3, 1, "")]
+      let forward = [edit(3, 1, ""), edit(3, 1, ""), edit(3, 1, "")]
+      for edits in [backspaces, forward]
+      {
+        let batch = CEUndoManager.batch(edits)
+        XCTAssertEqual(batch?.count, 1)
+        XCTAssertEqual(batch?.first?.range, NSRange(location: 3, length: 3))
+        XCTAssertEqual(applyBatch(batch ?? [], to: text), applySequentially(edits, to: text))
+      }
+    }
+
+    func test_batchesReplaceAll()
+    {
+      let text = String(repeating: "def Xform \"Prim\" {}\n", count: 100)
+      let ranges = (text as NSString).ranges(of: "Xform").reversed()
+      let edits = ranges.map { edit($0.location, $0.length, "Sphere") }
+      let batch = CEUndoManager.batch(edits)
+      XCTAssertEqual(batch?.count, 100)
+      XCTAssertEqual(applyBatch(batch ?? [], to: text), applySequentially(edits, to: text))
+
+      // Undoing the replace-all applies the inverses in reverse, each relative to the text left by the last.
+      let replaced = applySequentially(edits, to: text)
+      let inverses = ranges.reversed().map { edit($0.location, 6, "Xform") }
+      XCTAssertEqual(applySequentially(inverses, to: replaced), text)
+      XCTAssertEqual(applyBatch(CEUndoManager.batch(inverses) ?? [], to: replaced), text)
+    }
+
+    func test_registerSeparatelyStartsGroupsOfItsOwn()
+    {
+      let url = FileManager.default.temporaryDirectory
+        .appendingPathComponent("CEUndoManagerTests-\(UUID().uuidString).krj")
+      defer { try? FileManager.default.removeItem(at: url) }
+
+      let journal = EditJournal(url: url)!
+      _ = journal.recover(onto: "abc")
+      let undoManager = CEUndoManager()
+      undoManager.journal = journal
+
+      // Sequential inserts like these would otherwise be typed into one group.
+      func insert(_ string: String, at location: Int)
+      {
+        let mutation = TextMutation(string: string, range: NSRange(location: location, length: 0), limit: 3 + location)
+        let inverse = TextMutation(string: "", range: NSRange(location: location, length: 1), limit: 4 + location)
+        undoManager.registerMutations([(mutation, inverse)])
+      }
+      insert("x", at: 0)
+      undoManager.registerSeparately { insert("y", at: 1) }
+      insert("z", at: 2)
+      journal.flush()
+      XCTAssertEqual(undoManager.undoStack.count, 3)
+      XCTAssertEqual(EditJournal.replay(contentsOf: url, onto: "abc"), "xyzabc")
+    }
+
+    func test_unorderedEditsAreNotBatched()
+    {
+      XCTAssertNil(CEUndoManager.batch([edit(3, 0, "a"), edit(8, 0, "b"), edit(1, 0, "c")]))
+      XCTAssertNil(CEUndoManager.batch([edit(3, 2, "abc"), edit(4, 0, "b")]))
+    }
+  }
+
+  private extension NSString
+  {
+    func ranges(of string: String) -> [NSRange]
+    {
+      var ranges: [NSRange] = []
+      var searchRange = NSRange(location: 0, length: length)
+      var found = range(of: string, range: searchRange)
+      while found.location != NSNotFound
+      {
+        ranges.append(found)
+        searchRange = NSRange(location: NSMaxRange(found), length: length - NSMaxRange(found))
+        found = range(of: string, range: searchRange)
+      }
+      return ranges
+    }
+  }
+#endif
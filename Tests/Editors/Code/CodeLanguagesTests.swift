@@ -27,7 +27,9 @@
 import SwiftTreeSitter
 import XCTest
 @testable import CodeLanguages
-@testable import CosmoEditor
+#if canImport(CosmoEditor)
+  @testable import CosmoEditor
+#endif
 
 final class CodeLanguagesTests: XCTestCase
 {
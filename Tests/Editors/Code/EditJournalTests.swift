@@ -0,0 +1,122 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+#if canImport(CodeView)
+  import XCTest
+  @testable import CodeView
+
+  final class EditJournalTests: XCTestCase
+  {
+    let baseline = "def Xform \"Prim\"\n{\n}\n"
+    var url: URL!
+
+    override func setUp()
+    {
+      url = FileManager.default.temporaryDirectory
+        .appendingPathComponent("EditJournalTests-\(UUID().uuidString)")
+        .appendingPathComponent("journal.krj")
+    }
+
+    override func tearDown()
+    {
+      try? FileManager.default.removeItem(at: url.deletingLastPathComponent())
+    }
+
+    func test_replaysEditsOntoBaseline()
+    {
+      let journal = EditJournal(url: url)!
+      XCTAssertNil(journal.recover(onto: baseline))
+      journal.append(replacing: NSRange(location: 4, length: 5), with: "Sphere")
+      journal.append(replacing: NSRange(location: 20, length: 0), with: "  double radius = 2 🌍\n")
+      journal.append(replacing: NSRange(location: 0, length: 0), with: "#usda 1.0\n")
+      journal.flush()
+
+      let expected = "#usda 1.0\ndef Sphere \"Prim\"\n{\n  double radius = 2 🌍\n}\n"
+      XCTAssertEqual(EditJournal.replay(contentsOf: url, onto: baseline), expected)
+      XCTAssertEqual(EditJournal(url: url)?.recover(onto: baseline), expected)
+    }
+
+    func test_rejectsDifferentBaseline()
+    {
+      let journal = EditJournal(url: url)!
+      _ = journal.recover(onto: baseline)
+      journal.append(replacing: NSRange(location: 0, length: 0), with: "x")
+      journal.flush()
+
+      XCTAssertNil(EditJournal.replay(contentsOf: url, onto: baseline + " "))
+    }
+
+    func test_resetDiscardsEdits()
+    {
+      let journal = EditJournal(url: url)!
+      _ = journal.recover(onto: baseline)
+      journal.append(replacing: NSRange(location: 0, length: 3), with: "over")
+      journal.reset(baseline: "over Xform \"Prim\"\n{\n}\n")
+      journal.flush()
+
+      XCTAssertNil(EditJournal.replay(contentsOf: url, onto: baseline))
+      XCTAssertNil(EditJournal.replay(contentsOf: url, onto: "over Xform \"Prim\"\n{\n}\n"))
+    }
+
+    func test_recordsAfterResetReplayOntoSavedText()
+    {
+      let saved = "over Xform \"Prim\"\n{\n}\n"
+      let journal = EditJournal(url: url)!
+      _ = journal.recover(onto: baseline)
+      journal.reset(baseline: saved)
+      journal.append(replacing: NSRange(location: 0, length: 4), with: "def")
+      journal.flush()
+
+      XCTAssertEqual(EditJournal.replay(contentsOf: url, onto: saved), baseline)
+    }
+
+    func test_fingerprintIsStable()
+    {
+      // 64 bit FNV-1a, so journals and their file names are found again after a relaunch.
+      XCTAssertEqual(EditJournal.fingerprint(of: ""), 0xCBF2_9CE4_8422_2325)
+      XCTAssertEqual(EditJournal.fingerprint(of: "a"), 0xAF63_DC4C_8601_EC8C)
+    }
+
+    func test_dropsTornRecord() throws
+    {
+      let journal = EditJournal(url: url)!
+      _ = journal.recover(onto: baseline)
+      journal.append(replacing: NSRange(location: 0, length: 3), with: "over")
+      journal.append(replacing: NSRange(location: 0, length: 0), with: "torn by a crash")
+      journal.flush()
+
+      // Cut the last record short, as a crash mid-write would leave it.
+      let data = try Data(contentsOf: url)
+      try data.dropLast(6).write(to: url)
+
+      let recovered = EditJournal(url: url)!
+      XCTAssertEqual(recovered.recover(onto: baseline), "over Xform \"Prim\"\n{\n}\n")
+      recovered.append(replacing: NSRange(location: 0, length: 0), with: "#usda 1.0\n")
+      recovered.flush()
+      XCTAssertEqual(EditJournal.replay(contentsOf: url, onto: baseline), "#usda 1.0\nover Xform \"Prim\"\n{\n}\n")
+    }
+  }
+#endif
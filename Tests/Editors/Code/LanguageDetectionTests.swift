@@ -27,7 +27,9 @@
 import RegexBuilder
 import XCTest
 @testable import CodeLanguages
-@testable import CosmoEditor
+#if canImport(CosmoEditor)
+  @testable import CosmoEditor
+#endif
 
 // swiftlint:disable all
 final class LanguageDetectionTests: XCTestCase
@@ -151,6 +153,55 @@ final class LanguageDetectionTests: XCTestCase
       )
     }
   }
+
+  func test_detectFromBytes()
+  {
+    let cases = [
+      "#! /usr/bin/env -S python3 -u\nimport sys\n",
+      "#!/usr/bin/env A=B swift\n",
+      "// vim: set ts=2 sw=2 ft=rust:\nfn main() {}\n",
+      "-*- mode: TOML -*-\n[package]\n",
+      "# A plain comment, with no language hints at all.\n",
+    ]
+
+    for buffer in cases
+    {
+      let fromString = Editor.Code.Language.detectLanguageFrom(url: URL(filePath: ""), prefixBuffer: buffer)
+      let fromBytes = Editor.Code.Language.detectLanguageFrom(url: URL(filePath: ""), prefixBytes: Data(buffer.utf8))
+      XCTAssertEqual(fromString, fromBytes, "Byte and string detection disagree on \"\(buffer)\".")
+    }
+    XCTAssertEqual(
+      Editor.Code.Language.detectLanguageFrom(url: URL(filePath: ""), prefixBytes: Data("#!/usr/bin/env python3".utf8)),
+      .python
+    )
+  }
+
+  func test_detectLanguagesBatch() throws
+  {
+    let root = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+    try FileManager.default.createDirectory(at: root, withIntermediateDirectories: true)
+    defer { try? FileManager.default.removeItem(at: root) }
+
+    let lines = (0 ..< 20).map { "line \($0)" }.joined(separator: "\n")
+    let files: [(String, String?, Editor.Code.Language)] = [
+      ("main.swift", nil, .swift),
+      ("header.H", nil, .c),
+      ("script", "#!/usr/bin/env python3\n\(lines)\n", .python),
+      ("notes", "\(lines)\n// vim: ft=rust\n", .rust),
+      ("buried", "\(lines)\n// vim: ft=rust\n\(lines)\n", .default),
+      ("README", "Nothing to see here.\n", .default),
+      ("missing", nil, .default),
+    ]
+    for (name, contents, _) in files
+    {
+      try contents?.write(to: root.appendingPathComponent(name), atomically: false, encoding: .utf8)
+    }
+
+    let urls = (0 ..< 1000).map { root.appendingPathComponent(files[$0 % files.count].0) }
+    let languages = Editor.Code.Language.detectLanguages(for: urls)
+    XCTAssertEqual(languages, (0 ..< 1000).map { files[$0 % files.count].2 })
+    XCTAssertEqual(Editor.Code.Language.detectLanguages(for: urls, readingContents: false)[2], .default)
+  }
 }
 
 // swiftlint:enable all
@@ -0,0 +1,67 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+import XCTest
+@testable import CodeViewCore
+
+final class LineBreakClassifierTests: XCTestCase
+{
+  func test_matchesCharacterSets()
+  {
+    let breakable = CharacterSet.whitespacesAndNewlines.union(.punctuationCharacters)
+    for unit in 0 ... UInt16.max
+    {
+      guard let scalar = Unicode.Scalar(unit)
+      else
+      {
+        XCTAssertEqual(LineBreakClassifier.breakClass(of: unit), .other, "Surrogate \(unit)")
+        continue
+      }
+      XCTAssertEqual(LineBreakClassifier.canBreakLine(after: unit), breakable.contains(scalar), "U+\(unit)")
+    }
+  }
+
+  func test_classes()
+  {
+    let classes = "a \n.+\u{3000}\u{2028}、中".utf16.map(LineBreakClassifier.breakClass(of:))
+    XCTAssertEqual(
+      classes,
+      [.other, .whitespace, .newline, .punctuation, .other, .whitespace, .newline, .punctuation, .other]
+    )
+  }
+
+  func test_carriageReturnLineFeed()
+  {
+    let string = "a\r\nb\rc" as NSString
+    XCTAssertFalse(LineBreakClassifier.isInsideCarriageReturnLineFeed(string, at: 0))
+    XCTAssertFalse(LineBreakClassifier.isInsideCarriageReturnLineFeed(string, at: 1))
+    XCTAssertTrue(LineBreakClassifier.isInsideCarriageReturnLineFeed(string, at: 2))
+    XCTAssertFalse(LineBreakClassifier.isInsideCarriageReturnLineFeed(string, at: 3))
+    XCTAssertFalse(LineBreakClassifier.isInsideCarriageReturnLineFeed(string, at: 5))
+    XCTAssertFalse(LineBreakClassifier.isInsideCarriageReturnLineFeed(string, at: 6))
+  }
+}
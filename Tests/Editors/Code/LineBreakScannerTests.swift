@@ -0,0 +1,86 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+import XCTest
+@testable import CodeViewCore
+
+final class LineBreakScannerTests: XCTestCase
+{
+  /// Splits a string with `getLineStart`, the behavior the scanner has to match.
+  func referenceLines(of string: NSString) -> [LineBreakScanner.Line]
+  {
+    var lines: [LineBreakScanner.Line] = []
+    var location = 0
+    while location < string.length
+    {
+      var end = 0
+      string.getLineStart(nil, end: &end, contentsEnd: nil, for: NSRange(location: location, length: 0))
+      lines.append(LineBreakScanner.Line(length: end - location))
+      location = end
+    }
+    return lines
+  }
+
+  func test_lineEndings()
+  {
+    let string = "one\ntwo\r\nthree\rfour\u{2028}five\u{85}six" as NSString
+    let result = LineBreakScanner.scan(string)
+
+    XCTAssertEqual(result.lines, referenceLines(of: string))
+    XCTAssertEqual(result.lines.map(\.length), [4, 5, 6, 5, 5, 3])
+    XCTAssertEqual(result.histogram.lineFeed, 1)
+    XCTAssertEqual(result.histogram.carriageReturnLineFeed, 1)
+    XCTAssertEqual(result.histogram.carriageReturn, 1)
+    XCTAssertEqual(result.histogram.other, 2)
+    XCTAssertEqual(LineBreakScanner.scan("" as NSString).lines, [])
+  }
+
+  func test_matchesGetLineStart()
+  {
+    let pieces = ["a", "bc", "\n", "\r", "\r\n", "\t", "é", "中", "😀", "\u{2029}", String(repeating: "x", count: 40)]
+    var seed: UInt64 = 0x4B52_414B
+    for _ in 0 ..< 50
+    {
+      var string = ""
+      for _ in 0 ..< 400
+      {
+        seed = seed &* 6_364_136_223_846_793_005 &+ 1_442_695_040_888_963_407
+        string += pieces[Int(seed >> 33) % pieces.count]
+      }
+      let nsString = string as NSString
+      let expected = referenceLines(of: nsString)
+
+      // Small chunks exercise stitching lines, and `\r\n` pairs, back together across chunk boundaries.
+      for minimumChunkLength in [nsString.length, 64, 7]
+      {
+        let result = LineBreakScanner.scan(nsString, minimumChunkLength: minimumChunkLength)
+        XCTAssertEqual(result.lines, expected)
+        XCTAssertEqual(result.lines.reduce(0) { $0 + $1.length }, nsString.length)
+      }
+    }
+  }
+}
@@ -0,0 +1,125 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+import XCTest
+@testable import CodeViewCore
+
+final class MonospaceLayoutTests: XCTestCase
+{
+  let metrics = MonospaceLayout.Metrics(advance: 10, tabInterval: 40)
+  let line = "def Xform \"prim_42\" (kind = \"component\") { double3 xformOp:translate = (1, 2, 3) }\t// 中文\n"
+
+  func layout(
+    _ string: String,
+    maxWidth: CGFloat = .greatestFiniteMagnitude,
+    breakStrategy: LineBreakStrategy = .word,
+    metrics: MonospaceLayout.Metrics? = nil
+  ) -> [MonospaceLayout.Fragment]?
+  {
+    let string = string as NSString
+    return MonospaceLayout.layout(
+      string,
+      range: NSRange(location: 0, length: string.length),
+      metrics: metrics ?? self.metrics,
+      maxWidth: maxWidth,
+      breakStrategy: breakStrategy
+    )
+  }
+
+  func lengths(_ fragments: [MonospaceLayout.Fragment]?) -> [Int]?
+  {
+    fragments?.map(\.length)
+  }
+
+  func widths(_ fragments: [MonospaceLayout.Fragment]?) -> [CGFloat]?
+  {
+    fragments?.map(\.width)
+  }
+
+  func test_columns()
+  {
+    XCTAssertEqual(layout(""), [])
+    XCTAssertEqual(lengths(layout("let x = 1\n")), [10])
+    XCTAssertEqual(widths(layout("let x = 1\n")), [90])
+    XCTAssertEqual(widths(layout("let x = 1\r\n")), [90])
+    XCTAssertEqual(widths(layout("中文ab")), [60])
+  }
+
+  func test_tabs()
+  {
+    XCTAssertEqual(widths(layout("\tab\tc")), [90])
+    XCTAssertEqual(widths(layout("ab\t")), [40])
+    // A tab on a tab stop moves to the next one.
+    XCTAssertEqual(widths(layout("abcd\tx")), [90])
+    XCTAssertNil(layout("\tx", metrics: MonospaceLayout.Metrics(advance: 10, tabInterval: 0)))
+  }
+
+  func test_fallsBack()
+  {
+    XCTAssertNil(layout("caf\u{E9}"))
+    XCTAssertNil(layout("e\u{301}"))
+    XCTAssertNil(layout("smile 😀"))
+    XCTAssertNil(layout("bell \u{7}"))
+    XCTAssertNil(layout("one\u{2028}"))
+  }
+
+  func test_characterWrap()
+  {
+    let fragments = layout("abcdefghij", maxWidth: 35, breakStrategy: .character)
+    XCTAssertEqual(lengths(fragments), [3, 3, 3, 1])
+    XCTAssertEqual(widths(fragments), [30, 30, 30, 10])
+    // Wide characters aren't split, and line endings always fit.
+    XCTAssertEqual(lengths(layout("中中中\r\n", maxWidth: 45, breakStrategy: .character)), [2, 3])
+    XCTAssertEqual(lengths(layout("中\n", maxWidth: 5, breakStrategy: .character)), [2])
+  }
+
+  func test_wordWrap()
+  {
+    let fragments = layout("let value = foo", maxWidth: 100)
+    XCTAssertEqual(lengths(fragments), [10, 5])
+    XCTAssertEqual(widths(fragments), [100, 50])
+
+    // Walks back to the space, then breaks mid-word when there's nowhere to break.
+    XCTAssertEqual(lengths(layout("abc defghij", maxWidth: 60)), [4, 6, 1])
+    // Punctuation is a break opportunity, symbols aren't.
+    XCTAssertEqual(lengths(layout("foo.bar(baz)", maxWidth: 60)), [4, 4, 4])
+    XCTAssertEqual(lengths(layout("aaa+bbb+ccc", maxWidth: 60)), [6, 5])
+  }
+
+  func test_matchesCharacterCount()
+  {
+    for maxWidth: CGFloat in [15, 80, 333, .greatestFiniteMagnitude]
+    {
+      for breakStrategy in [LineBreakStrategy.word, .character]
+      {
+        let fragments = layout(line, maxWidth: maxWidth, breakStrategy: breakStrategy)
+        XCTAssertEqual(fragments?.reduce(0) { $0 + $1.length }, (line as NSString).length)
+        XCTAssertTrue(fragments?.allSatisfy { $0.width <= max(maxWidth, metrics.tabInterval) } ?? false)
+      }
+    }
+  }
+}
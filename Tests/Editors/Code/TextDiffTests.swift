@@ -0,0 +1,110 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+import XCTest
+@testable import CodeViewCore
+
+final class TextDiffTests: XCTestCase
+{
+  let text = """
+  #usda 1.0
+  def Xform "A"
+  {
+      double radius = 1
+  }
+  def Xform "B"
+  {
+      double radius = 2
+  }
+
+  """
+
+  func test_identicalTextsHaveNoEdits()
+  {
+    XCTAssertEqual(TextDiff.edits(from: text, to: text), [])
+    XCTAssertEqual(TextDiff.edits(from: "", to: ""), [])
+  }
+
+  func test_editsAreTrimmedToTheChangedCharacters()
+  {
+    let changed = text.replacingOccurrences(of: "radius = 2", with: "radius = 3")
+      .replacingOccurrences(of: "\"A\"", with: "\"Z\"")
+    let edits = TextDiff.edits(from: text, to: changed)
+
+    XCTAssertEqual(edits, [
+      TextDiff.Edit(range: NSRange(location: 21, length: 1), string: "Z"),
+      TextDiff.Edit(range: NSRange(location: 86, length: 1), string: "3"),
+    ])
+    XCTAssertEqual(TextDiff.apply(edits, to: text), changed)
+  }
+
+  func test_insertedAndRemovedPrims()
+  {
+    let prim = "def Xform \"C\"\n{\n    double radius = 5\n}\n"
+    let inserted = text + prim
+    XCTAssertEqual(TextDiff.edits(from: text, to: inserted), [
+      TextDiff.Edit(range: NSRange(location: (text as NSString).length, length: 0), string: prim),
+    ])
+    XCTAssertEqual(TextDiff.apply(TextDiff.edits(from: inserted, to: text), to: inserted), text)
+  }
+
+  func test_editsMatchRandomChanges()
+  {
+    var generator = SystemRandomNumberGenerator()
+    let alphabet: [Character] = ["a", "b", "\n", "é", "😀", "\n"]
+    for _ in 0 ..< 500
+    {
+      let old = String((0 ..< Int.random(in: 0 ..< 60, using: &generator)).map
+      { _ in
+        alphabet.randomElement(using: &generator)!
+      })
+      var new = Array(old)
+      for _ in 0 ..< Int.random(in: 0 ..< 5, using: &generator)
+      {
+        let idx = Int.random(in: 0 ... new.count, using: &generator)
+        if Bool.random(using: &generator) || new.isEmpty
+        {
+          new.insert(alphabet.randomElement(using: &generator)!, at: idx)
+        }
+        else
+        {
+          new.remove(at: min(idx, new.count - 1))
+        }
+      }
+
+      for limit in [1024, 1, 0]
+      {
+        let edits = TextDiff.edits(from: old, to: String(new), limit: limit)
+        XCTAssertEqual(TextDiff.apply(edits, to: old), String(new), "\(old.debugDescription) -> \(edits)")
+        for (lhs, rhs) in zip(edits, edits.dropFirst())
+        {
+          XCTAssertLessThanOrEqual(NSMaxRange(lhs.range), rhs.range.location)
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,228 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+import XCTest
+@testable import CodeViewCore
+
+final class TextLineStorageTests: XCTestCase
+{
+  struct Line: Identifiable
+  {
+    let id: Int
+  }
+
+  /// A fixed-seed generator so failures are reproducible.
+  struct Generator: RandomNumberGenerator
+  {
+    var state: UInt64
+
+    mutating func next() -> UInt64
+    {
+      state = state &* 6_364_136_223_846_793_005 &+ 1_442_695_040_888_963_407
+      return state
+    }
+  }
+
+  /// Walks the whole tree, asserting parent links, left subtree metadata and the red-black properties.
+  /// - Returns: The subtree's length, height, count and black height.
+  @discardableResult
+  func validate(
+    _ storage: TextLineStorage<Line>,
+    node: UInt32? = nil,
+    file: StaticString = #filePath,
+    line: UInt = #line
+  ) -> (length: Int, height: CGFloat, count: Int, blackHeight: Int)
+  { // swiftlint:disable:this large_tuple
+    let node = node ?? storage.root
+    let nodes = storage.nodes
+    guard node != TextLineStorage<Line>.null else { return (0, 0, 0, 1) }
+
+    let left = nodes.left[node]
+    let right = nodes.right[node]
+    if left != TextLineStorage<Line>.null
+    {
+      XCTAssertEqual(nodes.parent[left], node, "Left child has the wrong parent", file: file, line: line)
+    }
+    if right != TextLineStorage<Line>.null
+    {
+      XCTAssertEqual(nodes.parent[right], node, "Right child has the wrong parent", file: file, line: line)
+    }
+    if nodes.color[node] == .red
+    {
+      XCTAssertEqual(nodes.color[left], .black, "Red node has a red child", file: file, line: line)
+      XCTAssertEqual(nodes.color[right], .black, "Red node has a red child", file: file, line: line)
+    }
+
+    let leftMeta = validate(storage, node: left, file: file, line: line)
+    let rightMeta = validate(storage, node: right, file: file, line: line)
+    XCTAssertEqual(nodes.leftSubtreeOffset[node], leftMeta.length, file: file, line: line)
+    XCTAssertEqual(nodes.leftSubtreeHeight[node], leftMeta.height, file: file, line: line)
+    XCTAssertEqual(Int(nodes.leftSubtreeCount[node]), leftMeta.count, file: file, line: line)
+    XCTAssertEqual(leftMeta.blackHeight, rightMeta.blackHeight, "Unequal black height", file: file, line: line)
+
+    return (
+      nodes.length[node] + leftMeta.length + rightMeta.length,
+      nodes.height[node] + leftMeta.height + rightMeta.height,
+      1 + leftMeta.count + rightMeta.count,
+      leftMeta.blackHeight + (nodes.color[node] == .black ? 1 : 0)
+    )
+  }
+
+  func test_build()
+  {
+    for lineCount in [1, 2, 3, 7, 8, 100, 1000]
+    {
+      let storage = TextLineStorage<Line>()
+      let lines = (0 ..< lineCount).map
+      {
+        TextLineStorage<Line>.BuildItem(data: Line(id: $0), length: $0 + 1, height: nil)
+      }
+      storage.build(from: lines, estimatedLineHeight: 10)
+
+      XCTAssertEqual(storage.count, lineCount)
+      XCTAssertEqual(storage.length, lines.reduce(0) { $0 + $1.length })
+      XCTAssertEqual(storage.height, CGFloat(lineCount) * 10)
+      XCTAssertEqual(storage.nodes.color[storage.root], .black)
+      let meta = validate(storage)
+      XCTAssertEqual(meta.count, lineCount)
+
+      var offset = 0
+      for (idx, position) in storage.enumerated()
+      {
+        XCTAssertEqual(position.data.id, idx)
+        XCTAssertEqual(position.range, NSRange(location: offset, length: idx + 1))
+        offset += idx + 1
+      }
+    }
+  }
+
+  func test_insertAndDelete()
+  {
+    let storage = TextLineStorage<Line>()
+    var lengths: [Int] = []
+    var generator = Generator(state: 0x4B52_414B)
+
+    for id in 0 ..< 2000
+    {
+      let index = Int.random(in: 0 ... lengths.count, using: &generator)
+      let offset = lengths[..<index].reduce(0, +)
+      let length = Int.random(in: 1 ... 80, using: &generator)
+      storage.insert(line: Line(id: id), atOffset: offset, length: length, height: 1)
+      lengths.insert(length, at: index)
+    }
+    validate(storage)
+
+    for _ in 0 ..< 1500
+    {
+      let index = Int.random(in: 0 ..< lengths.count, using: &generator)
+      storage.delete(lineAt: lengths[..<index].reduce(0, +))
+      lengths.remove(at: index)
+    }
+    validate(storage)
+
+    XCTAssertEqual(storage.count, lengths.count)
+    XCTAssertEqual(storage.length, lengths.reduce(0, +))
+    for (position, length) in zip(storage, lengths)
+    {
+      XCTAssertEqual(position.range.length, length)
+    }
+
+    // Freed slots are reused rather than growing the pool.
+    let slotCount = storage.nodes.slotCount
+    for id in 0 ..< 1000
+    {
+      storage.insert(line: Line(id: id), atOffset: 0, length: 1, height: 1)
+    }
+    XCTAssertEqual(storage.nodes.slotCount, slotCount)
+    validate(storage)
+  }
+
+  func test_update()
+  {
+    let storage = TextLineStorage<Line>()
+    let lines = (0 ..< 100).map { TextLineStorage<Line>.BuildItem(data: Line(id: $0), length: 10, height: 5) }
+    storage.build(from: lines, estimatedLineHeight: 5)
+
+    storage.update(atIndex: 505, delta: 4, deltaHeight: 2)
+    XCTAssertEqual(storage.length, 1004)
+    XCTAssertEqual(storage.height, 502)
+    XCTAssertEqual(storage.getLine(atOffset: 505)?.range, NSRange(location: 500, length: 14))
+    XCTAssertEqual(storage.getLine(atIndex: 51)?.range.location, 514)
+    XCTAssertEqual(storage.getLine(atPosition: 252)?.index, 50)
+    XCTAssertEqual(storage.getLine(atPosition: 257)?.index, 51)
+    validate(storage)
+  }
+
+  func test_iterators()
+  {
+    let storage = TextLineStorage<Line>()
+    let lines = (0 ..< 100).map { TextLineStorage<Line>.BuildItem(data: Line(id: $0), length: 10, height: 5) }
+    storage.build(from: lines, estimatedLineHeight: 5)
+
+    XCTAssertEqual(storage.map(\.index), Array(0 ..< 100))
+    XCTAssertEqual(storage.map(\.range.location), (0 ..< 100).map { $0 * 10 })
+    XCTAssertEqual(storage.linesInRange(NSRange(location: 95, length: 30)).map(\.index), [9, 10, 11, 12])
+    XCTAssertEqual(storage.linesStartingAt(52, until: 70).map(\.index), [10, 11, 12, 13, 14])
+    XCTAssertEqual(storage.linesStartingAt(1000, until: 2000).map(\.index), [99])
+
+    // Layout grows each line as it iterates, later lines must see the new heights.
+    var positions: [CGFloat] = []
+    for position in storage.linesStartingAt(0, until: 20)
+    {
+      positions.append(position.yPos)
+      storage.update(atIndex: position.range.location, delta: 0, deltaHeight: 5)
+    }
+    XCTAssertEqual(positions, [0, 10, 20])
+    validate(storage)
+  }
+
+  func test_snapshotIsUnaffectedByEdits()
+  {
+    let storage = TextLineStorage<Line>()
+    let lines = (0 ..< 5000).map { TextLineStorage<Line>.BuildItem(data: Line(id: $0), length: 10, height: 1) }
+    storage.build(from: lines, estimatedLineHeight: 1)
+
+    let snapshot = storage.snapshot()
+    storage.update(atIndex: 25, delta: 5, deltaHeight: 1)
+    storage.delete(lineAt: 40_000)
+    storage.insert(line: Line(id: -1), atOffset: 0, length: 3, height: 1)
+    validate(storage)
+
+    XCTAssertEqual(snapshot.count, 5000)
+    XCTAssertEqual(snapshot.length, 50000)
+    XCTAssertEqual(snapshot.getLine(atOffset: 25)?.range, NSRange(location: 20, length: 10))
+    XCTAssertEqual(snapshot.getLine(atIndex: 4000)?.data.id, 4000)
+    XCTAssertEqual(snapshot.getLine(atPosition: 4999.5)?.index, 4999)
+    XCTAssertEqual(snapshot.lineAndColumn(forOffset: 50000)?.line, 4999)
+    XCTAssertEqual(snapshot.lineAndColumn(forOffset: 50000)?.column, 10)
+
+    XCTAssertEqual(storage.count, 5000)
+    XCTAssertEqual(storage.length, 49998)
+    XCTAssertEqual(storage.getLine(atIndex: 0)?.data.id, -1)
+    XCTAssertEqual(storage.getLine(atOffset: 28)?.range, NSRange(location: 23, length: 15))
+  }
+}
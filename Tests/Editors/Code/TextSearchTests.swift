@@ -0,0 +1,211 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+import XCTest
+@testable import CodeViewCore
+
+final class TextSearchTests: XCTestCase
+{
+  let text = """
+  #usda 1.0
+  def Xform "Root"
+  {
+      def Sphere "Ball" { double radius = 2 }
+      def sphere "ball" { double RADIUS = 4 }
+  }
+
+  """ as NSString
+
+  /// The locations of `needle` in `haystack`, found by ``SubstringSearch``.
+  func locations(of needle: String, in haystack: String, isCaseSensitive: Bool = true) -> [Int]
+  {
+    let needle = Array(needle.utf16)
+    let haystack = Array(haystack.utf16)
+    return haystack.withUnsafeBufferPointer
+    { haystack in
+      needle.withUnsafeBufferPointer
+      {
+        SubstringSearch.locations(of: $0, in: haystack, isCaseSensitive: isCaseSensitive)
+      }
+    }
+  }
+
+  // MARK: - SubstringSearch
+
+  func test_substringSearchMatchesFoundation()
+  {
+    var generator = SystemRandomNumberGenerator()
+    for _ in 0 ..< 200
+    {
+      let haystack = String((0 ..< Int.random(in: 0 ..< 300, using: &generator)).map
+      { _ in
+        "abAB".randomElement(using: &generator)!
+      })
+      let needle = String((0 ..< Int.random(in: 1 ..< 4, using: &generator)).map
+      { _ in
+        "abAB".randomElement(using: &generator)!
+      })
+      for isCaseSensitive in [true, false]
+      {
+        var expected: [Int] = []
+        var searchRange = NSRange(location: 0, length: (haystack as NSString).length)
+        let options: NSString.CompareOptions = isCaseSensitive ? [.literal] : [.literal, .caseInsensitive]
+        var found = (haystack as NSString).range(of: needle, options: options, range: searchRange)
+        while found.location != NSNotFound
+        {
+          expected.append(found.location)
+          searchRange = NSRange(location: NSMaxRange(found), length: (haystack as NSString).length - NSMaxRange(found))
+          found = (haystack as NSString).range(of: needle, options: options, range: searchRange)
+        }
+        XCTAssertEqual(
+          locations(of: needle, in: haystack, isCaseSensitive: isCaseSensitive),
+          expected,
+          "\(needle) in \(haystack)"
+        )
+      }
+    }
+  }
+
+  func test_substringSearchEdges()
+  {
+    XCTAssertEqual(locations(of: "a", in: ""), [])
+    XCTAssertEqual(locations(of: "abc", in: "ab"), [])
+    XCTAssertEqual(locations(of: "aa", in: "aaaaa"), [0, 2])
+    XCTAssertEqual(locations(of: "🌍", in: "hello 🌍 world 🌍"), [6, 15])
+    XCTAssertEqual(locations(of: "z", in: String(repeating: "a", count: 40) + "z"), [40])
+  }
+
+  // MARK: - SearchResultIndex
+
+  func test_indexShiftsRangesAcrossEdits()
+  {
+    var index = SearchResultIndex()
+    let ranges = (0 ..< 2000).map { NSRange(location: $0 * 10, length: 3) }
+    index.insert(contentsOf: ranges.filter { $0.location % 20 == 0 })
+    index.insert(contentsOf: ranges.filter { $0.location % 20 != 0 })
+    XCTAssertEqual(index.ranges, ranges)
+
+    // Inserting before a range moves it, inserting inside one removes it.
+    index.applyEdit(range: NSRange(location: 10, length: 0), replacementLength: 5)
+    index.applyEdit(range: NSRange(location: 26, length: 0), replacementLength: 1)
+    XCTAssertEqual(index.count, 1999)
+    XCTAssertEqual(Array(index.ranges.prefix(3)), [0, 15, 36].map { NSRange(location: $0, length: 3) })
+    XCTAssertEqual(index.last, NSRange(location: 19996, length: 3))
+
+    // Deleting across many blocks removes the ranges inside and moves the ones after.
+    index.applyEdit(range: NSRange(location: 100, length: 10000), replacementLength: 0)
+    XCTAssertEqual(index.ranges(intersecting: NSRange(location: 90, length: 20)).map(\.location), [96, 106])
+    XCTAssertEqual(index.first(startingAt: 97), NSRange(location: 106, length: 3))
+    XCTAssertEqual(index.last(endingAt: 101), NSRange(location: 96, length: 3))
+    XCTAssertEqual(index.count, index.ranges.count)
+  }
+
+  func test_indexDropsOverlappingRanges()
+  {
+    var index = SearchResultIndex()
+    index.insert(contentsOf: [NSRange(location: 0, length: 2), NSRange(location: 10, length: 2)])
+    index.insert(contentsOf: [NSRange(location: 1, length: 2), NSRange(location: 5, length: 2)])
+    XCTAssertEqual(index.ranges.map(\.location), [0, 5, 10])
+    XCTAssertEqual(index.count, 3)
+  }
+
+  // MARK: - TextSearchEngine
+
+  func test_matches()
+  {
+    typealias Query = TextSearchEngine.Query
+    XCTAssertEqual(TextSearchEngine.matches(of: Query("sphere"), in: text).count, 2)
+    XCTAssertEqual(TextSearchEngine.matches(of: Query("sphere", isCaseSensitive: true), in: text).count, 1)
+    XCTAssertEqual(TextSearchEngine.matches(of: Query("radius", isCaseSensitive: true), in: text).count, 1)
+    XCTAssertEqual(TextSearchEngine.matches(of: Query("^\\s+def", mode: .regularExpression), in: text).count, 2)
+    XCTAssertEqual(TextSearchEngine.matches(of: Query("(", mode: .regularExpression), in: text), [])
+    XCTAssertEqual(TextSearchEngine.matches(of: Query(""), in: text), [])
+  }
+
+  func test_replacements()
+  {
+    let query = TextSearchEngine.Query("radius = (\\d)", mode: .regularExpression)
+    let replacements = TextSearchEngine.replacements(of: query, with: "radius = $1.5", in: text)
+    XCTAssertEqual(replacements.map(\.string), ["radius = 2.5", "radius = 4.5"])
+  }
+
+  func test_streamsResultsAndRefreshesAroundEdits()
+  {
+    let text = NSMutableString(string: String(repeating: "def Sphere \"Ball\" {}\n", count: 5000))
+    let engine = TextSearchEngine()
+    engine.chunkLength = 1000
+    let finished = expectation(description: "search finished")
+    engine.onUpdate =
+    { engine in
+      if !engine.isSearching
+      {
+        finished.fulfill()
+      }
+    }
+    engine.search(TextSearchEngine.Query("Sphere"), in: text)
+    wait(for: [finished], timeout: 10)
+    engine.onUpdate = nil
+    XCTAssertEqual(engine.results.count, 5000)
+
+    // Break the first match and create a new one, then shift the rest.
+    text.replaceCharacters(in: NSRange(location: 4, length: 1), with: "")
+    engine.textDidChange(in: NSRange(location: 4, length: 1), replacementLength: 0, text: text)
+    text.insert("sphere", at: 0)
+    engine.textDidChange(in: NSRange(location: 0, length: 0), replacementLength: 6, text: text)
+    XCTAssertEqual(engine.results.count, 5000)
+    XCTAssertEqual(engine.results.first, NSRange(location: 0, length: 6))
+    XCTAssertEqual(engine.results.ranges, TextSearchEngine.matches(of: TextSearchEngine.Query("Sphere"), in: text))
+  }
+
+  func test_overlappingMatchesAcrossChunksAreStitched()
+  {
+    // Odd chunk lengths put a match of "aa" across every boundary, and the next chunk's matches out of step.
+    let text = NSString(string: String(repeating: "a", count: 10000) + "b" + String(repeating: "aaa", count: 1000))
+    let query = TextSearchEngine.Query("aa")
+    for chunkLength in [7, 1001, 4096]
+    {
+      let engine = TextSearchEngine()
+      engine.chunkLength = chunkLength
+      let finished = expectation(description: "search finished")
+      engine.onUpdate =
+      { engine in
+        if !engine.isSearching
+        {
+          finished.fulfill()
+        }
+      }
+      engine.search(query, in: text)
+      wait(for: [finished], timeout: 10)
+      engine.onUpdate = nil
+      XCTAssertEqual(
+        engine.results.ranges,
+        TextSearchEngine.matches(of: query, in: text),
+        "chunk length \(chunkLength)"
+      )
+    }
+  }
+}
@@ -0,0 +1,109 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+#if canImport(CodeView)
+  import AppKit
+  import XCTest
+  @testable import CodeView
+
+  final class TypesetCacheTests: XCTestCase
+  {
+    let displayData = TextLine.DisplayData(maxWidth: 100, lineHeightMultiplier: 1.0, estimatedLineHeight: 14)
+    let font = NSFont.monospacedSystemFont(ofSize: 12, weight: .regular)
+
+    func test_reusesIdenticalContent()
+    {
+      let cache = TypesetCache()
+      let string = NSAttributedString(string: "let value = someFunction(argument) // wraps", attributes: [.font: font])
+      // Monospaced lines skip CoreText and the cache, so typeset these with CoreText.
+      let first = Typesetter()
+      first.allowsMonospaceLayout = false
+      first.typeset(string, displayData: displayData, breakStrategy: .word, markedRanges: nil, cache: cache)
+      XCTAssertEqual(cache.count, 1)
+
+      let copy = NSAttributedString(attributedString: string)
+      let second = Typesetter()
+      second.allowsMonospaceLayout = false
+      second.typeset(copy, displayData: displayData, breakStrategy: .word, markedRanges: nil, cache: cache)
+      XCTAssertEqual(cache.count, 1)
+      XCTAssertEqual(first.lineFragments.count, second.lineFragments.count)
+      XCTAssertGreaterThan(second.lineFragments.count, 1)
+      for (lhs, rhs) in zip(first.lineFragments, second.lineFragments)
+      {
+        XCTAssertEqual(lhs.range, rhs.range)
+        XCTAssertEqual(lhs.height, rhs.height)
+        XCTAssertTrue(lhs.data.ctLine === rhs.data.ctLine)
+        // Lines sharing a layout still need their own fragment views.
+        XCTAssertNotEqual(lhs.data.id, rhs.data.id)
+      }
+    }
+
+    func test_skipsMonospaceLayout()
+    {
+      let cache = TypesetCache()
+      let string = NSAttributedString(string: "def Xform \"World\"", attributes: [.font: font])
+      let typesetter = Typesetter()
+      typesetter.typeset(string, displayData: displayData, breakStrategy: .word, markedRanges: nil, cache: cache)
+      XCTAssertEqual(cache.count, 0)
+      XCTAssertEqual(typesetter.lineFragments.count, 1)
+    }
+
+    func test_keysDifferByAttributesAndDisplayData()
+    {
+      let plain = NSAttributedString(string: "prim", attributes: [.font: font])
+      let colored = NSAttributedString(string: "prim", attributes: [.font: font, .foregroundColor: NSColor.red])
+      let key = TypesetCache.key(for: plain, displayData: displayData, breakStrategy: .word)
+      XCTAssertEqual(key, TypesetCache.key(for: plain, displayData: displayData, breakStrategy: .word))
+      XCTAssertNotEqual(key, TypesetCache.key(for: colored, displayData: displayData, breakStrategy: .word))
+      XCTAssertNotEqual(key, TypesetCache.key(for: plain, displayData: displayData, breakStrategy: .character))
+      let wider = TextLine.DisplayData(maxWidth: 200, lineHeightMultiplier: 1.0, estimatedLineHeight: 14)
+      XCTAssertNotEqual(key, TypesetCache.key(for: plain, displayData: wider, breakStrategy: .word))
+    }
+
+    func test_evictsLeastRecentlyUsed()
+    {
+      // Each entry costs its length plus one, so three 4 character lines fit.
+      let cache = TypesetCache(costLimit: 15)
+      let strings = ["aaaa", "bbbb", "cccc", "dddd"].map { NSAttributedString(string: $0, attributes: [.font: font]) }
+      let keys = strings.map { TypesetCache.key(for: $0, displayData: displayData, breakStrategy: .word) }
+      for (key, string) in zip(keys, strings).prefix(3)
+      {
+        cache.insert([], for: key, string: string)
+      }
+      XCTAssertNotNil(cache.fragments(for: keys[0], string: strings[0]))
+
+      cache.insert([], for: keys[3], string: strings[3])
+      XCTAssertEqual(cache.count, 3)
+      XCTAssertNotNil(cache.fragments(for: keys[0], string: strings[0]))
+      XCTAssertNil(cache.fragments(for: keys[1], string: strings[1]))
+      XCTAssertNotNil(cache.fragments(for: keys[2], string: strings[2]))
+      XCTAssertNotNil(cache.fragments(for: keys[3], string: strings[3]))
+
+      // A colliding key with different content is a miss.
+      XCTAssertNil(cache.fragments(for: keys[0], string: strings[2]))
+    }
+  }
+#endif
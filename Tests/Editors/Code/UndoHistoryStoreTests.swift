@@ -0,0 +1,77 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+#if canImport(CodeView)
+  import XCTest
+  @testable import CodeView
+
+  final class UndoHistoryStoreTests: XCTestCase
+  {
+    let large = String(repeating: "def Xform \"Prim\" {\n}\n", count: 1000)
+
+    func test_smallStringsStayInline()
+    {
+      let store = UndoHistoryStore()
+      let text = store.store("let x = 1\r\n")
+      XCTAssertEqual(text.string, "let x = 1\r\n")
+      XCTAssertEqual(text.utf16Length, 11)
+      XCTAssertEqual(text.last, "\r\n")
+      XCTAssertEqual(store.string(for: text), "let x = 1\r\n")
+    }
+
+    func test_largeStringsAreCompressedAndShared()
+    {
+      let store = UndoHistoryStore()
+      let first = store.store(large)
+      let second = store.store(large)
+      XCTAssertNil(first.string)
+      XCTAssertLessThan(first.cost, large.utf8.count / 10)
+      XCTAssertEqual(first.utf16Length, (large as NSString).length)
+      XCTAssertEqual(store.string(for: first), large)
+      guard case let .compressed(lhs) = first.storage, case let .compressed(rhs) = second.storage
+      else
+      {
+        return XCTFail("Expected compressed text")
+      }
+      XCTAssertTrue(lhs === rhs)
+    }
+
+    func test_spill()
+    {
+      let store = UndoHistoryStore()
+      let small = store.spill(store.store("x"))
+      XCTAssertEqual(small.string, "x")
+
+      let medium = String(repeating: "é", count: 300)
+      let texts = [store.store(large), store.store(medium)].map(store.spill)
+      XCTAssertEqual(texts.map(\.cost), [0, 0])
+      XCTAssertEqual(texts.map(store.string(for:)), [large, medium])
+
+      store.removeAll()
+      XCTAssertNil(store.string(for: texts[0]))
+    }
+  }
+#endif
@@ -0,0 +1,117 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+import XCTest
+@testable import CodeViewCore
+
+final class WorkspaceSearchTests: XCTestCase
+{
+  var root: URL!
+
+  override func setUpWithError() throws
+  {
+    root = FileManager.default.temporaryDirectory.appendingPathComponent("WorkspaceSearchTests-\(UUID().uuidString)")
+    let layers = root.appendingPathComponent("layers")
+    try FileManager.default.createDirectory(at: layers, withIntermediateDirectories: true)
+    try "def Sphere \"Ball\"\n{\n    double radius = 2\n}\n".write(
+      to: layers.appendingPathComponent("ball.usda"),
+      atomically: true,
+      encoding: .utf8
+    )
+    try "let radius = 1\r\nlet RADIUS = 2\r\n// 🌍 radius\r\n".write(
+      to: root.appendingPathComponent("radius.swift"),
+      atomically: true,
+      encoding: .utf8
+    )
+    try Data("PXR-USDC radius".utf8).write(to: layers.appendingPathComponent("crate.usdc"))
+    try Data([0x72, 0x61, 0x64, 0x00, 0x69, 0x75, 0x73] + Array("radius".utf8))
+      .write(to: root.appendingPathComponent("blob.bin"))
+    try "radius".write(to: root.appendingPathComponent(".hidden"), atomically: true, encoding: .utf8)
+  }
+
+  override func tearDownWithError() throws
+  {
+    try FileManager.default.removeItem(at: root)
+  }
+
+  func search(_ query: TextSearchEngine.Query) -> [WorkspaceSearch.FileResult]
+  {
+    let options = WorkspaceSearch.Options(skippedExtensions: ["usdc"])
+    let lock = NSLock()
+    var results: [WorkspaceSearch.FileResult] = []
+    WorkspaceSearch.search(WorkspaceSearch.files(in: [root], options: options), for: query, options: options)
+    { result in
+      lock.lock()
+      results.append(result)
+      lock.unlock()
+    }
+    return results.sorted { $0.url.lastPathComponent < $1.url.lastPathComponent }
+  }
+
+  func test_skipsBinaryHiddenAndSkippedFiles()
+  {
+    let files = WorkspaceSearch.files(in: [root], options: WorkspaceSearch.Options(skippedExtensions: ["usdc"]))
+    XCTAssertEqual(Set(files.map(\.lastPathComponent)), ["ball.usda", "radius.swift", "blob.bin"])
+    XCTAssertEqual(search(TextSearchEngine.Query("radius")).map(\.url.lastPathComponent), ["ball.usda", "radius.swift"])
+  }
+
+  func test_findsLinesAndRanges()
+  {
+    let results = search(TextSearchEngine.Query("radius"))
+    XCTAssertEqual(results[0].matches, [WorkspaceSearch.Match(
+      lineNumber: 3,
+      line: "    double radius = 2",
+      range: NSRange(location: 11, length: 6)
+    )])
+    XCTAssertEqual(results[1].matches.map(\.lineNumber), [1, 2, 3])
+    XCTAssertEqual(results[1].matches.map(\.line), ["let radius = 1", "let RADIUS = 2", "// 🌍 radius"])
+    XCTAssertEqual(results[1].matches.map(\.range.location), [4, 4, 6])
+
+    let sensitive = search(TextSearchEngine.Query("RADIUS", isCaseSensitive: true))
+    XCTAssertEqual(sensitive.flatMap(\.matches).map(\.lineNumber), [2])
+
+    let regex = search(TextSearchEngine.Query("radius = \\d", mode: .regularExpression))
+    XCTAssertEqual(regex.map(\.matches.count), [1, 2])
+    XCTAssertEqual(regex[1].matches.map(\.range), [NSRange(location: 4, length: 10), NSRange(location: 4, length: 10)])
+  }
+
+  func test_ranksFileNameMatchesFirst()
+  {
+    let search = WorkspaceSearch(skippedExtensions: ["USDC"])
+    let finished = expectation(description: "search finished")
+    search.onUpdate =
+    { search in
+      if !search.isSearching
+      {
+        finished.fulfill()
+      }
+    }
+    search.search(TextSearchEngine.Query("radius"), in: [root])
+    wait(for: [finished], timeout: 10)
+    XCTAssertEqual(search.results.map(\.url.lastPathComponent), ["radius.swift", "ball.usda"])
+  }
+}
@@ -0,0 +1,235 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+import XCTest
+
+/// # Benchmarks
+///
+/// Every benchmark in this target runs a block a fixed number of times over a fixed corpus (see ``Corpus``)
+/// and compares the median wall-clock time against the baseline stored in `Baselines/<os>-<arch>.json`.
+/// A benchmark fails when it is slower than its baseline by more than the tolerance, or when it has no
+/// baseline while others on this platform do. When the platform has no baselines at all, every benchmark is
+/// skipped rather than passed.
+///
+/// Baselines are only meaningful for optimized builds, record and compare them with:
+/// ```
+/// swift test -c release -Xswiftc -enable-testing --filter CodeBenchmarks
+/// ```
+/// - `KRAKEN_RECORD_BASELINES=1` overwrites the stored baselines with the results of the current run.
+/// - `KRAKEN_BENCHMARK_TOLERANCE` sets the allowed regression as a fraction, defaults to `0.25` (25%).
+class BenchmarkTestCase: XCTestCase
+{
+  /// Skips the benchmark when no baselines have been recorded for this platform, as there's nothing to compare
+  /// against.
+  override func setUpWithError() throws
+  {
+    try super.setUpWithError()
+    let baselines = Baselines.shared
+    if !baselines.isRecording, baselines.isEmpty
+    {
+      throw XCTSkip(
+        "No baselines recorded in \(baselines.url.lastPathComponent), record them with KRAKEN_RECORD_BASELINES=1."
+      )
+    }
+  }
+
+  /// Measures `block` and reports the median against the stored baseline.
+  /// - Parameters:
+  ///   - name: The name of the benchmark, defaults to the calling test method.
+  ///   - iterations: The number of times to run `block`.
+  ///   - block: The work to measure.
+  func benchmark(
+    _ name: String = #function,
+    iterations: Int = 10,
+    file: StaticString = #filePath,
+    line: UInt = #line,
+    _ block: () -> Void
+  )
+  {
+    benchmark(name, iterations: iterations, file: file, line: line, setUp: {}, { _ in block() })
+  }
+
+  /// Measures `block` and reports the median against the stored baseline.
+  ///
+  /// Use this variant when every iteration needs fresh state (eg: an empty storage object to insert into).
+  /// The `setUp` closure is not included in the measurement.
+  /// - Parameters:
+  ///   - name: The name of the benchmark, defaults to the calling test method.
+  ///   - iterations: The number of times to run `block`.
+  ///   - setUp: Creates the state passed to each iteration.
+  ///   - block: The work to measure.
+  func benchmark<State>(
+    _ name: String = #function,
+    iterations: Int = 10,
+    file: StaticString = #filePath,
+    line: UInt = #line,
+    setUp: () -> State,
+    _ block: (inout State) -> Void
+  )
+  {
+    let clock = ContinuousClock()
+    var samples: [Double] = []
+    samples.reserveCapacity(iterations)
+
+    for _ in 0 ..< iterations
+    {
+      var state = setUp()
+      let elapsed = clock.measure { block(&state) }
+      samples.append(elapsed.seconds)
+    }
+
+    let testName = name.hasSuffix("()") ? String(name.dropLast(2)) : name
+    Baselines.shared.report(
+      "\(String(describing: type(of: self))).\(testName)",
+      median: samples.sorted()[samples.count / 2],
+      file: file,
+      line: line
+    )
+  }
+}
+
+/// Loads, compares and records benchmark baselines.
+final class Baselines
+{
+  static let shared: Baselines = .init()
+
+  /// The baseline file for this platform. Lives next to the sources so recorded runs can be committed.
+  let url: URL
+  /// True when the current run should overwrite the stored baselines.
+  let isRecording: Bool
+  /// The allowed slowdown before a benchmark fails, as a fraction of the baseline.
+  let tolerance: Double
+
+  /// Median seconds keyed by `<test case>.<test name>`.
+  private var values: [String: Double]
+
+  /// True when no baselines have been recorded for this platform.
+  var isEmpty: Bool { values.isEmpty }
+
+  private init()
+  {
+    let environment = ProcessInfo.processInfo.environment
+    url = URL(fileURLWithPath: #filePath)
+      .deletingLastPathComponent()
+      .appendingPathComponent("Baselines")
+      .appendingPathComponent("\(Self.platform).json")
+    isRecording = environment["KRAKEN_RECORD_BASELINES"] == "1"
+    tolerance = environment["KRAKEN_BENCHMARK_TOLERANCE"].flatMap(Double.init) ?? 0.25
+
+    if let data = try? Data(contentsOf: url),
+       let values = try? JSONDecoder().decode([String: Double].self, from: data)
+    {
+      self.values = values
+    }
+    else
+    {
+      values = [:]
+    }
+  }
+
+  /// Prints the result of a benchmark and fails the calling test if it regressed or has no baseline.
+  ///
+  /// Only called when the platform has baselines, otherwise the benchmark was skipped in `setUpWithError`.
+  /// - Parameters:
+  ///   - key: The benchmark's key in the baseline file.
+  ///   - median: The measured median, in seconds.
+  func report(_ key: String, median: Double, file: StaticString, line: UInt)
+  {
+    let baseline = values[key]
+    var message = "[benchmark] \(key): \(Self.format(median))"
+    if let baseline
+    {
+      message += " (baseline \(Self.format(baseline)), \(String(format: "%+.1f", (median / baseline - 1) * 100))%)"
+    }
+    print(message)
+
+    if isRecording
+    {
+      values[key] = median
+      save()
+    }
+    else if baseline == nil
+    {
+      XCTFail(
+        "\(key) has no baseline in \(url.lastPathComponent), record one with KRAKEN_RECORD_BASELINES=1.",
+        file: file,
+        line: line
+      )
+    }
+    else if let baseline, median > baseline * (1 + tolerance)
+    {
+      XCTFail(
+        "\(key) regressed: \(Self.format(median)) against a baseline of \(Self.format(baseline)).",
+        file: file,
+        line: line
+      )
+    }
+  }
+
+  private func save()
+  {
+    let encoder = JSONEncoder()
+    encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+    guard let data = try? encoder.encode(values) else { return }
+    try? data.write(to: url, options: .atomic)
+  }
+
+  private static func format(_ seconds: Double) -> String
+  {
+    String(format: "%.3fms", seconds * 1000)
+  }
+
+  private static var platform: String
+  {
+    #if os(Linux)
+      let system = "linux"
+    #elseif os(macOS)
+      let system = "macos"
+    #else
+      let system = "unknown"
+    #endif
+
+    #if arch(arm64)
+      let architecture = "arm64"
+    #elseif arch(x86_64)
+      let architecture = "x86_64"
+    #else
+      let architecture = "unknown"
+    #endif
+
+    return "\(system)-\(architecture)"
+  }
+}
+
+extension Duration
+{
+  /// The duration as fractional seconds.
+  var seconds: Double
+  {
+    Double(components.seconds) + Double(components.attoseconds) * 1e-18
+  }
+}
@@ -0,0 +1,231 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+
+/// Fixed inputs for the benchmarks.
+///
+/// Everything here is generated from a constant seed so every run, on every machine, measures the exact
+/// same documents, edit positions and file names.
+enum Corpus
+{
+  /// The seed used by every benchmark's random number generator.
+  static let seed: UInt64 = 0x4B52_414B_454E
+
+  /// A `.usda` layer with `primCount` prims under a single default prim.
+  /// - Parameter primCount: The number of prims to generate, each one is roughly twenty lines long.
+  /// - Returns: The layer's contents.
+  static func usda(primCount: Int) -> String
+  {
+    var rng = SplitMix64(seed: seed)
+    var result = """
+    #usda 1.0
+    (
+        defaultPrim = "World"
+        metersPerUnit = 0.01
+        upAxis = "Z"
+    )
+
+    def Xform "World"
+    {
+
+    """
+    result.reserveCapacity(primCount * 700)
+
+    for idx in 0 ..< primCount
+    {
+      let x = Double(Int.random(in: -1000 ... 1000, using: &rng)) / 10
+      let y = Double(Int.random(in: -1000 ... 1000, using: &rng)) / 10
+      let radius = Double(Int.random(in: 1 ... 100, using: &rng)) / 10
+      result += """
+          def Xform "Prim_\(idx)" (
+              kind = "component"
+          )
+          {
+              double3 xformOp:translate = (\(x), \(y), 0)
+              uniform token[] xformOpOrder = ["xformOp:translate"]
+              custom string userNote = "generated prim \(idx)"
+
+              def Sphere "Geom"
+              {
+                  float3[] extent = [(-\(radius), -\(radius), -\(radius)), (\(radius), \(radius), \(radius))]
+                  double radius = \(radius)
+                  color3f[] primvars:displayColor = [(0.1, 0.\(idx % 10), 0.8)]
+              }
+          }
+
+
+      """
+    }
+
+    result += "}\n"
+    return result
+  }
+
+  /// A Swift source file made of `count` copies of a small, varied declaration block.
+  static func swift(count: Int) -> String
+  {
+    var result = "import Foundation\n\n"
+    result.reserveCapacity(count * 600)
+
+    for idx in 0 ..< count
+    {
+      result += """
+      /// Documentation for `Model\(idx)`.
+      public struct Model\(idx): Hashable
+      {
+        public let id: Int = \(idx)
+        public var name: String = "model \\(\(idx))"
+        private var values: [Double] = [1.0, 2.5, \(idx).0]
+
+        // Sums every value that passes the filter.
+        func total(where isIncluded: (Double) -> Bool = { _ in true }) -> Double
+        {
+          values.filter(isIncluded).reduce(0, +)
+        }
+
+        mutating func append(_ value: Double) throws
+        {
+          guard value.isFinite else { throw CocoaError(.coderInvalidValue) }
+          values.append(value * 0x\(String(idx, radix: 16)))
+        }
+      }
+
+
+      """
+    }
+
+    return result
+  }
+
+  /// A C++ source file where every function is preceded by a raw string literal with a `json` delimiter.
+  /// The C++ injections query turns each of those literals into an injected JSON language layer.
+  static func cpp(functionCount: Int) -> String
+  {
+    var result = "#include <cstdio>\n\n"
+    result.reserveCapacity(functionCount * 250)
+
+    for idx in 0 ..< functionCount
+    {
+      result += """
+      static const char *config\(idx) = R"json({"name": "prim_\(idx)", "size": [1, 2, \(idx)], "visible": true})json";
+
+      int function\(idx)(int value)
+      {
+        return value * \(idx) + std::printf("%s", config\(idx));
+      }
+
+
+      """
+    }
+
+    return result
+  }
+
+  /// A single line of minified JavaScript, with long unbroken runs like embedded base64 data.
+  /// - Parameter length: The minimum length of the line, in UTF-16 code units.
+  static func minifiedJavaScript(length: Int) -> String
+  {
+    var rng = SplitMix64(seed: seed)
+    let alphabet = Array("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789")
+    var result = "!function(e){"
+    result.reserveCapacity(length + 512)
+
+    var idx = 0
+    while result.utf16.count < length
+    {
+      if idx % 8 == 7
+      {
+        let dataLength = Int.random(in: 100 ... 400, using: &rng)
+        let data = String((0 ..< dataLength).map { _ in alphabet.randomElement(using: &rng)! })
+        result += "var d\(idx)=\"data:image/png;base64,\(data)\";"
+      }
+      else
+      {
+        result += "function f\(idx)(a,b){return a.map(function(c){return c*\(idx)+b[c%\(idx + 1)]||e.x\(idx)})};"
+      }
+      idx += 1
+    }
+
+    result += "}(this);"
+    return result
+  }
+
+  /// Line lengths, in UTF-16 code units, for a document of `count` lines.
+  static func lineLengths(count: Int) -> [Int]
+  {
+    var rng = SplitMix64(seed: seed)
+    return (0 ..< count).map { _ in Int.random(in: 1 ... 120, using: &rng) }
+  }
+
+  /// File names mixing every supported extension with unsupported and extension-less names.
+  static func fileNames(count: Int) -> [String]
+  {
+    let extensions = [
+      "c", "h", "cc", "cpp", "hpp", "galah", "json", "py", "rs", "swift", "toml", "usd", "usda", "usdc",
+      "usdz", "txt", "md", "png", "yml", "",
+    ]
+    let bareNames = ["Makefile", "Dockerfile", "LICENSE", "README"]
+
+    var rng = SplitMix64(seed: seed)
+    return (0 ..< count).map
+    { idx in
+      let ext = extensions.randomElement(using: &rng)!
+      return ext.isEmpty ? bareNames[idx % bareNames.count] : "file\(idx).\(ext)"
+    }
+  }
+
+  /// Document prefixes exercising the shebang and modeline detection paths.
+  static let prefixBuffers: [String] = [
+    "#!/usr/bin/env swift\nprint(\"hello\")\n",
+    "#! /usr/bin/env -S python3 -u\nimport sys\n",
+    "#!/bin/rust\nfn main() {}\n",
+    "// vim: set ts=2 sw=2 ft=rust:\nfn main() {}\n",
+    "/* vim: other=param a=b ft=swift b=d\n*/\n",
+    "-*- mode: toml -*-\n[package]\n",
+    "# A plain comment, with no language hints at all.\nsome text\n",
+  ]
+}
+
+/// A small, seedable random number generator, see: https://prng.di.unimi.it/splitmix64.c
+struct SplitMix64: RandomNumberGenerator
+{
+  private var state: UInt64
+
+  init(seed: UInt64)
+  {
+    state = seed
+  }
+
+  mutating func next() -> UInt64
+  {
+    state &+= 0x9E37_79B9_7F4A_7C15
+    var value = state
+    value = (value ^ (value >> 30)) &* 0xBF58_476D_1CE4_E5B9
+    value = (value ^ (value >> 27)) &* 0x94D0_49BB_1331_11EB
+    return value ^ (value >> 31)
+  }
+}
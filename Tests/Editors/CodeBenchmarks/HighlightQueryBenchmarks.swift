@@ -0,0 +1,79 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeLanguages
+import Foundation
+import SwiftTreeSitter
+import XCTest
+
+final class HighlightQueryBenchmarks: BenchmarkTestCase
+{
+  /// Parses `source` once, then measures running the language's highlight query over the whole document.
+  /// - Parameters:
+  ///   - language: The language to parse and query with.
+  ///   - source: The document to highlight.
+  func benchmarkHighlights(
+    _ name: String = #function,
+    language: Editor.Code.Language,
+    source: String
+  ) throws
+  {
+    let parser = Parser()
+    try parser.setLanguage(XCTUnwrap(language.language))
+    let tree = try XCTUnwrap(parser.parse(source))
+    let rootNode = try XCTUnwrap(tree.rootNode)
+    let query = try XCTUnwrap(TreeSitterModel.shared.query(for: language.id))
+
+    benchmark(name)
+    {
+      let cursor = query.execute(node: rootNode, in: tree)
+      let captureCount = cursor.flatMap(\.captures).count
+      XCTAssertGreaterThan(captureCount, 0)
+    }
+  }
+
+  func test_highlightQueryUSD() throws
+  {
+    try benchmarkHighlights(language: .usd, source: Corpus.usda(primCount: 2_000))
+  }
+
+  func test_highlightQuerySwift() throws
+  {
+    try benchmarkHighlights(language: .swift, source: Corpus.swift(count: 2_000))
+  }
+
+  func test_parseUSD() throws
+  {
+    let source = Corpus.usda(primCount: 2_000)
+    let parser = Parser()
+    try parser.setLanguage(XCTUnwrap(Editor.Code.Language.usd.language))
+
+    benchmark
+    {
+      XCTAssertNotNil(parser.parse(source))
+    }
+  }
+}
@@ -0,0 +1,85 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeLanguages
+import Foundation
+import XCTest
+
+final class LanguageDetectionBenchmarks: BenchmarkTestCase
+{
+  func test_detectLanguageFromURL()
+  {
+    let urls = Corpus.fileNames(count: 10_000).map { URL(fileURLWithPath: "/workspace/\($0)") }
+
+    benchmark
+    {
+      var detected = 0
+      for url in urls where Editor.Code.Language.detectLanguageFrom(url: url) != .default
+      {
+        detected += 1
+      }
+      XCTAssertGreaterThan(detected, 0)
+    }
+  }
+
+  func test_detectLanguageFromContents()
+  {
+    let url = URL(fileURLWithPath: "/workspace/script")
+    let buffers = (0 ..< 10_000).map { Corpus.prefixBuffers[$0 % Corpus.prefixBuffers.count] }
+
+    benchmark
+    {
+      var detected = 0
+      for buffer in buffers
+        where Editor.Code.Language.detectLanguageFrom(url: url, prefixBuffer: buffer, suffixBuffer: buffer) != .default
+      {
+        detected += 1
+      }
+      XCTAssertGreaterThan(detected, 0)
+    }
+  }
+
+  /// Classifies a workspace of 10k files, reading the ones without a recognized name or extension.
+  func test_detectLanguagesBatch()
+  {
+    let root = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+    try? FileManager.default.createDirectory(at: root, withIntermediateDirectories: true)
+    defer { try? FileManager.default.removeItem(at: root) }
+
+    let urls = Corpus.fileNames(count: 10_000).enumerated().map
+    { idx, name in
+      let url = root.appendingPathComponent(name.contains(".") ? name : "\(name)_\(idx)")
+      try? Corpus.prefixBuffers[idx % Corpus.prefixBuffers.count].write(to: url, atomically: false, encoding: .utf8)
+      return url
+    }
+
+    benchmark
+    {
+      let detected = Editor.Code.Language.detectLanguages(for: urls).filter { $0 != .default }.count
+      XCTAssertGreaterThan(detected, 0)
+    }
+  }
+}
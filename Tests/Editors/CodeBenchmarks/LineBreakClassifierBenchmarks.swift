@@ -0,0 +1,117 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeViewCore
+import Foundation
+import XCTest
+#if canImport(CodeView)
+  import AppKit
+  @testable import CodeView
+#endif
+
+final class LineBreakClassifierBenchmarks: BenchmarkTestCase
+{
+  /// Roughly 1MB of minified JavaScript on a single line.
+  static let line = Corpus.minifiedJavaScript(length: 1 << 20) as NSString
+
+  /// Wrapped at 80 columns of 7pt.
+  static let maxWidth: CGFloat = 560
+
+  /// Classifies every code unit of the line.
+  func test_classifyPerformance()
+  {
+    let units = Array((Self.line as String).utf16)
+    benchmark
+    {
+      var breakCount = 0
+      for unit in units where LineBreakClassifier.canBreakLine(after: unit)
+      {
+        breakCount += 1
+      }
+      XCTAssertGreaterThan(breakCount, 0)
+    }
+  }
+
+  /// Baseline for ``test_classifyPerformance()``, classifying with `CharacterSet`.
+  func test_classifyCharacterSetPerformance()
+  {
+    let units = Array((Self.line as String).utf16)
+    benchmark
+    {
+      var breakCount = 0
+      for unit in units
+      {
+        guard let scalar = Unicode.Scalar(unit) else { continue }
+        if CharacterSet.whitespacesAndNewlines.contains(scalar) || CharacterSet.punctuationCharacters.contains(scalar)
+        {
+          breakCount += 1
+        }
+      }
+      XCTAssertGreaterThan(breakCount, 0)
+    }
+  }
+
+  /// Word wraps the line with ``MonospaceLayout``.
+  func test_wrapMinifiedLinePerformance()
+  {
+    let metrics = MonospaceLayout.Metrics(advance: 7, tabInterval: 28)
+    benchmark
+    {
+      let fragments = MonospaceLayout.layout(
+        Self.line,
+        range: NSRange(location: 0, length: Self.line.length),
+        metrics: metrics,
+        maxWidth: Self.maxWidth,
+        breakStrategy: .word
+      )
+      XCTAssertGreaterThan(fragments?.count ?? 0, Self.line.length / 80)
+    }
+  }
+
+  #if canImport(CodeView)
+    /// Word wraps the line with `Typesetter`'s CoreText path, which classifies break candidates in place of
+    /// creating a substring and `CharacterSet` for each one.
+    func test_typesetMinifiedLinePerformance()
+    {
+      let string = NSAttributedString(
+        string: Self.line as String,
+        attributes: [.font: NSFont.monospacedSystemFont(ofSize: 12, weight: .regular)]
+      )
+      let displayData = TextLine.DisplayData(
+        maxWidth: Self.maxWidth,
+        lineHeightMultiplier: 1.0,
+        estimatedLineHeight: 14
+      )
+      benchmark(iterations: 3)
+      {
+        let typesetter = Typesetter()
+        typesetter.allowsMonospaceLayout = false
+        typesetter.typeset(string, displayData: displayData, breakStrategy: .word, markedRanges: nil)
+        XCTAssertGreaterThan(typesetter.lineFragments.count, 1)
+      }
+    }
+  #endif
+}
@@ -0,0 +1,65 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeViewCore
+import Foundation
+import XCTest
+
+final class LineBreakScannerBenchmarks: BenchmarkTestCase
+{
+  /// Roughly 10MB of `.usda` text, the size of document that made opening files slow.
+  static let document = Corpus.usda(primCount: 15000) as NSString
+
+  func test_scanPerformance()
+  {
+    let document = Self.document
+    benchmark
+    {
+      let result = LineBreakScanner.scan(document)
+      XCTAssertGreaterThan(result.lines.count, 0)
+      XCTAssertGreaterThan(result.histogram.lineFeed, 0)
+    }
+  }
+
+  /// Baseline for ``test_scanPerformance()``, finding one line at a time with `getLineStart`.
+  func test_getLineStartPerformance()
+  {
+    let document = Self.document
+    benchmark
+    {
+      var lineCount = 0
+      var location = 0
+      while location < document.length
+      {
+        var end = 0
+        document.getLineStart(nil, end: &end, contentsEnd: nil, for: NSRange(location: location, length: 0))
+        lineCount += 1
+        location = end
+      }
+      XCTAssertGreaterThan(lineCount, 0)
+    }
+  }
+}
@@ -0,0 +1,105 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeViewCore
+import Foundation
+import XCTest
+#if canImport(CodeView)
+  import AppKit
+  @testable import CodeView
+#endif
+
+final class MonospaceLayoutBenchmarks: BenchmarkTestCase
+{
+  /// Lines of `.usda` text, wrapped at 80 columns of 7pt.
+  static let lines: [String] = Corpus.usda(primCount: 2000)
+    .split(separator: "\n", omittingEmptySubsequences: false)
+    .map { String($0) }
+
+  static let maxWidth: CGFloat = 560
+
+  /// Lays out every line arithmetically, the work the monospace path does in place of CoreText.
+  func test_monospaceLayoutPerformance()
+  {
+    let lines = Self.lines.map { $0 as NSString }
+    let metrics = MonospaceLayout.Metrics(advance: 7, tabInterval: 28)
+    benchmark
+    {
+      var fragmentCount = 0
+      for line in lines
+      {
+        fragmentCount += MonospaceLayout.layout(
+          line,
+          range: NSRange(location: 0, length: line.length),
+          metrics: metrics,
+          maxWidth: Self.maxWidth,
+          breakStrategy: .word
+        )?.count ?? 0
+      }
+      XCTAssertGreaterThan(fragmentCount, lines.count / 2)
+    }
+  }
+
+  #if canImport(CodeView)
+    /// Typesets every line with `Typesetter`, taking the monospace path.
+    func test_typesetMonospacePerformance()
+    {
+      typesetAll(allowsMonospaceLayout: true)
+    }
+
+    /// Baseline for ``test_typesetMonospacePerformance()``, typesetting every line with CoreText.
+    func test_typesetCoreTextPerformance()
+    {
+      typesetAll(allowsMonospaceLayout: false)
+    }
+
+    private func typesetAll(allowsMonospaceLayout: Bool)
+    {
+      let attributes: [NSAttributedString.Key: Any] = [
+        .font: NSFont.monospacedSystemFont(ofSize: 12, weight: .regular),
+        .foregroundColor: NSColor.textColor,
+      ]
+      let lines = Self.lines.map { NSAttributedString(string: $0, attributes: attributes) }
+      let displayData = TextLine.DisplayData(
+        maxWidth: Self.maxWidth,
+        lineHeightMultiplier: 1.2,
+        estimatedLineHeight: 14
+      )
+      benchmark
+      {
+        let typesetter = Typesetter()
+        typesetter.allowsMonospaceLayout = allowsMonospaceLayout
+        var height: CGFloat = 0
+        for line in lines
+        {
+          typesetter.typeset(line, displayData: displayData, breakStrategy: .word, markedRanges: nil)
+          height += typesetter.lineFragments.height
+        }
+        XCTAssertGreaterThan(height, 0)
+      }
+    }
+  #endif
+}
@@ -0,0 +1,56 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeViewCore
+import Foundation
+import XCTest
+
+final class TextDiffBenchmarks: BenchmarkTestCase
+{
+  /// Roughly 4MB of usda.
+  static let text = Corpus.usda(primCount: 10000)
+
+  /// The text with a handful of attribute values changed throughout, as a programmatic stage edit would.
+  static let edited: String =
+  {
+    var lines = text.components(separatedBy: "\n")
+    for part in 1 ... 6
+    {
+      lines[part * lines.count / 7] += " # edited"
+    }
+    return lines.joined(separator: "\n")
+  }()
+
+  /// Diffs a large document against a few scattered edits of itself.
+  func test_scatteredEditsPerformance()
+  {
+    _ = Self.edited
+    benchmark
+    {
+      XCTAssertEqual(TextDiff.edits(from: Self.text, to: Self.edited).count, 6)
+    }
+  }
+}
@@ -0,0 +1,308 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeViewCore
+import Foundation
+import XCTest
+
+final class TextLineStorageBenchmarks: BenchmarkTestCase
+{
+  /// The storage only needs an `Identifiable` payload, use the cheapest one possible.
+  struct Line: Identifiable
+  {
+    let id: Int
+  }
+
+  /// The number of lines in the pre-built documents.
+  static let lineCount = 100_000
+  /// The number of operations each benchmark performs per iteration.
+  static let operationCount = 100_000
+
+  static let estimatedLineHeight: CGFloat = 14
+
+  /// Builds a storage object with ``lineCount`` lines of fixed, pseudo-random lengths.
+  func makeStorage() -> TextLineStorage<Line>
+  {
+    let storage = TextLineStorage<Line>()
+    storage.build(from: makeBuildItems(lineCount: Self.lineCount), estimatedLineHeight: Self.estimatedLineHeight)
+    return storage
+  }
+
+  func makeBuildItems(lineCount: Int) -> [TextLineStorage<Line>.BuildItem]
+  {
+    Corpus.lineLengths(count: lineCount).enumerated().map
+    {
+      TextLineStorage<Line>.BuildItem(data: Line(id: $0.offset), length: $0.element, height: nil)
+    }
+  }
+
+  // MARK: - Build
+
+  func test_buildPerformance()
+  {
+    let lines = makeBuildItems(lineCount: 1_000_000)
+    benchmark(setUp: { TextLineStorage<Line>() })
+    { storage in
+      storage.build(from: lines, estimatedLineHeight: Self.estimatedLineHeight)
+      XCTAssertEqual(storage.count, 1_000_000)
+    }
+  }
+
+  // MARK: - Insert
+
+  func test_insertPerformance()
+  {
+    benchmark(setUp: { TextLineStorage<Line>() })
+    { storage in
+      var rng = SplitMix64(seed: Corpus.seed)
+      for idx in 0 ..< Self.operationCount
+      {
+        storage.insert(
+          line: Line(id: idx),
+          atOffset: Int.random(in: 0 ... storage.length, using: &rng),
+          length: Int.random(in: 1 ... 120, using: &rng),
+          height: Self.estimatedLineHeight
+        )
+      }
+      XCTAssertEqual(storage.count, Self.operationCount)
+    }
+  }
+
+  // MARK: - Delete
+
+  func test_deletePerformance()
+  {
+    benchmark(setUp: { makeStorage() })
+    { storage in
+      var rng = SplitMix64(seed: Corpus.seed)
+      for _ in 0 ..< Self.lineCount / 2
+      {
+        storage.delete(lineAt: Int.random(in: 0 ..< storage.length, using: &rng))
+      }
+      XCTAssertEqual(storage.count, Self.lineCount / 2)
+    }
+  }
+
+  // MARK: - Update
+
+  func test_updatePerformance()
+  {
+    benchmark(setUp: { makeStorage() })
+    { storage in
+      var rng = SplitMix64(seed: Corpus.seed)
+      for _ in 0 ..< Self.operationCount
+      {
+        storage.update(
+          atIndex: Int.random(in: 0 ..< storage.length, using: &rng),
+          delta: 1,
+          deltaHeight: 0
+        )
+      }
+    }
+  }
+
+  func test_updateHeightPerformance()
+  {
+    benchmark(setUp: { makeStorage() })
+    { storage in
+      var rng = SplitMix64(seed: Corpus.seed)
+      for _ in 0 ..< Self.operationCount
+      {
+        storage.update(
+          atIndex: Int.random(in: 0 ..< storage.length, using: &rng),
+          delta: 0,
+          deltaHeight: 1
+        )
+      }
+    }
+  }
+
+  // MARK: - Snapshot
+
+  /// Takes a snapshot before every edit, as a background reader would, so each edit pays for copy-on-write.
+  func test_snapshotEditPerformance()
+  {
+    benchmark(setUp: { makeStorage() })
+    { storage in
+      var rng = SplitMix64(seed: Corpus.seed)
+      var snapshots: [TextLineStorage<Line>.Snapshot] = []
+      for _ in 0 ..< Self.operationCount / 10
+      {
+        snapshots.append(storage.snapshot())
+        storage.update(
+          atIndex: Int.random(in: 0 ..< storage.length, using: &rng),
+          delta: 1,
+          deltaHeight: 0
+        )
+        if snapshots.count > 4
+        {
+          snapshots.removeFirst()
+        }
+      }
+      XCTAssertEqual(snapshots.last?.count, Self.lineCount)
+    }
+  }
+
+  // MARK: - Search
+
+  func test_searchOffsetPerformance()
+  {
+    let storage = makeStorage()
+    benchmark
+    {
+      var rng = SplitMix64(seed: Corpus.seed)
+      var checksum = 0
+      for _ in 0 ..< Self.operationCount
+      {
+        checksum &+= storage.getLine(atOffset: Int.random(in: 0 ..< storage.length, using: &rng))?.index ?? 0
+      }
+      XCTAssertNotEqual(checksum, 0)
+    }
+  }
+
+  func test_searchIndexPerformance()
+  {
+    let storage = makeStorage()
+    benchmark
+    {
+      var rng = SplitMix64(seed: Corpus.seed)
+      var checksum = 0
+      for _ in 0 ..< Self.operationCount
+      {
+        checksum &+= storage.getLine(atIndex: Int.random(in: 0 ..< storage.count, using: &rng))?.range.location ?? 0
+      }
+      XCTAssertNotEqual(checksum, 0)
+    }
+  }
+
+  func test_searchPositionPerformance()
+  {
+    let storage = makeStorage()
+    benchmark
+    {
+      var rng = SplitMix64(seed: Corpus.seed)
+      var checksum = 0
+      for _ in 0 ..< Self.operationCount
+      {
+        let posY = CGFloat(Int.random(in: 0 ..< Int(storage.height), using: &rng))
+        checksum &+= storage.getLine(atPosition: posY)?.index ?? 0
+      }
+      XCTAssertNotEqual(checksum, 0)
+    }
+  }
+
+  // MARK: - Iteration
+
+  /// The number of lines in the documents used by the iteration benchmarks.
+  static let iterationLineCount = 1_000_000
+
+  func makeIterationStorage() -> TextLineStorage<Line>
+  {
+    let storage = TextLineStorage<Line>()
+    storage.build(
+      from: makeBuildItems(lineCount: Self.iterationLineCount),
+      estimatedLineHeight: Self.estimatedLineHeight
+    )
+    return storage
+  }
+
+  /// Walks every line with the storage's own iterator, which follows successor links.
+  func test_iterateAllPerformance()
+  {
+    let storage = makeIterationStorage()
+    benchmark
+    {
+      var checksum = 0
+      for line in storage
+      {
+        checksum &+= line.range.length
+      }
+      XCTAssertEqual(checksum, storage.length)
+    }
+  }
+
+  /// Baseline for ``test_iterateAllPerformance()``, finding each line with a search from the root.
+  func test_iterateAllBySearchPerformance()
+  {
+    let storage = makeIterationStorage()
+    benchmark
+    {
+      var checksum = 0
+      var offset = 0
+      while offset < storage.length, let line = storage.getLine(atOffset: offset)
+      {
+        checksum &+= line.range.length
+        offset = NSMaxRange(line.range)
+      }
+      XCTAssertEqual(checksum, storage.length)
+    }
+  }
+
+  /// Walks a tall viewport's worth of lines from a random position, as layout does on scroll.
+  func test_iterateVisibleLinesPerformance()
+  {
+    let storage = makeIterationStorage()
+    let viewportHeight = Self.estimatedLineHeight * 200
+    benchmark
+    {
+      var rng = SplitMix64(seed: Corpus.seed)
+      var checksum = 0
+      for _ in 0 ..< Self.operationCount / 100
+      {
+        let minY = CGFloat(Int.random(in: 0 ..< Int(storage.height - viewportHeight), using: &rng))
+        for line in storage.linesStartingAt(minY, until: minY + viewportHeight)
+        {
+          checksum &+= line.index
+        }
+      }
+      XCTAssertNotEqual(checksum, 0)
+    }
+  }
+
+  /// Baseline for ``test_iterateVisibleLinesPerformance()``, finding each line with a search from the root.
+  func test_iterateVisibleLinesBySearchPerformance()
+  {
+    let storage = makeIterationStorage()
+    let viewportHeight = Self.estimatedLineHeight * 200
+    benchmark
+    {
+      var rng = SplitMix64(seed: Corpus.seed)
+      var checksum = 0
+      for _ in 0 ..< Self.operationCount / 100
+      {
+        let minY = CGFloat(Int.random(in: 0 ..< Int(storage.height - viewportHeight), using: &rng))
+        var line = storage.getLine(atPosition: minY)
+        while let current = line
+        {
+          checksum &+= current.index
+          guard current.yPos < minY + viewportHeight else { break }
+          line = storage.getLine(atOffset: NSMaxRange(current.range))
+        }
+      }
+      XCTAssertNotEqual(checksum, 0)
+    }
+  }
+}
@@ -0,0 +1,90 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import CodeViewCore
+import Foundation
+import XCTest
+
+final class TextSearchBenchmarks: BenchmarkTestCase
+{
+  /// Roughly 4MB of usda.
+  static let text = Corpus.usda(primCount: 10000) as NSString
+
+  /// Finds every occurrence of a word with ``SubstringSearch``.
+  func test_literalSearchPerformance()
+  {
+    let haystack = Array((Self.text as String).utf16)
+    let needle = Array("radius".utf16)
+    benchmark
+    {
+      let locations = haystack.withUnsafeBufferPointer
+      { haystack in
+        needle.withUnsafeBufferPointer { SubstringSearch.locations(of: $0, in: haystack, isCaseSensitive: false) }
+      }
+      XCTAssertGreaterThan(locations.count, 0)
+    }
+  }
+
+  /// Baseline for ``test_literalSearchPerformance()``, searching with `NSString.range(of:options:range:)`.
+  func test_literalSearchFoundationPerformance()
+  {
+    let text = Self.text
+    benchmark
+    {
+      var count = 0
+      var searchRange = NSRange(location: 0, length: text.length)
+      var found = text.range(of: "radius", options: [.literal, .caseInsensitive], range: searchRange)
+      while found.location != NSNotFound
+      {
+        count += 1
+        searchRange = NSRange(location: NSMaxRange(found), length: text.length - NSMaxRange(found))
+        found = text.range(of: "radius", options: [.literal, .caseInsensitive], range: searchRange)
+      }
+      XCTAssertGreaterThan(count, 0)
+    }
+  }
+
+  /// Indexes every match and then applies a thousand scattered edits to the index.
+  func test_resultIndexEditPerformance()
+  {
+    let matches = TextSearchEngine.matches(of: TextSearchEngine.Query("def"), in: Self.text)
+    var generator = SplitMix64(seed: Corpus.seed)
+    let edits = (0 ..< 1000).map
+    { _ in
+      NSRange(location: Int(generator.next() % UInt64(Self.text.length)), length: 0)
+    }
+    benchmark
+    {
+      var index = SearchResultIndex()
+      index.insert(contentsOf: matches)
+      for edit in edits
+      {
+        index.applyEdit(range: edit, replacementLength: 1)
+      }
+      XCTAssertGreaterThan(index.count, 0)
+    }
+  }
+}
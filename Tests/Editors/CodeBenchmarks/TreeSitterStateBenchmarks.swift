@@ -0,0 +1,79 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+#if canImport(CosmoEditor)
+  import CodeLanguages
+  import Foundation
+  import SwiftTreeSitter
+  import XCTest
+  @testable import CosmoEditor
+
+  /// `TreeSitterState` lives in `CosmoEditor`, which requires AppKit, so these only run on macOS.
+  final class TreeSitterStateBenchmarks: BenchmarkTestCase
+  {
+    static let source = Corpus.cpp(functionCount: 2_000) as NSString
+
+    /// Mirrors `CodeView.createReadBlock()`, reading UTF-16 chunks of at most 1024 characters.
+    let readBlock: Parser.ReadBlock = { byteOffset, _ in
+      let source = TreeSitterStateBenchmarks.source
+      let location = byteOffset / 2
+      let end = min(location + 1024, source.length)
+      guard location < end else { return nil }
+      return source.substring(with: NSRange(location ..< end)).data(using: String.nativeUTF16Encoding)
+    }
+
+    let readCallback: SwiftTreeSitter.Predicate.TextProvider = { range, _ in
+      TreeSitterStateBenchmarks.source.substring(with: range)
+    }
+
+    /// The initial parse, including discovering and parsing every injected layer.
+    func test_initialParseWithInjections()
+    {
+      benchmark(iterations: 5)
+      {
+        let state = TreeSitterState(codeLanguage: .cpp, readCallback: readCallback, readBlock: readBlock)
+        XCTAssertGreaterThan(state.layers.count, 1)
+      }
+    }
+
+    /// The injection pass run after every edit, with every existing layer still present.
+    func test_injectionUpdatePerformance()
+    {
+      let state = TreeSitterState(codeLanguage: .cpp, readCallback: readCallback, readBlock: readBlock)
+      XCTAssertGreaterThan(state.layers.count, 1, "The corpus should produce injected JSON layers.")
+
+      benchmark
+      {
+        _ = state.updateInjectedLayers(
+          readCallback: readCallback,
+          readBlock: readBlock,
+          touchedLayers: Set(state.layers.dropFirst())
+        )
+      }
+      XCTAssertGreaterThan(state.layers.count, 1)
+    }
+  }
+#endif
@@ -0,0 +1,94 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+#if canImport(CodeView)
+  import AppKit
+  import Foundation
+  import XCTest
+  @testable import CodeView
+
+  /// `Typesetter` lives in `CodeView`, which requires AppKit, so these only run on macOS.
+  final class TypesetCacheBenchmarks: BenchmarkTestCase
+  {
+    /// Lines of `.usda` text, styled like a highlighted document.
+    static let lines: [NSAttributedString] = Corpus.usda(primCount: 200)
+      .split(separator: "\n", omittingEmptySubsequences: false)
+      .map
+      { line in
+        let string = NSMutableAttributedString(
+          string: String(line),
+          attributes: [.font: NSFont.monospacedSystemFont(ofSize: 12, weight: .regular)]
+        )
+        if let space = line.firstIndex(of: " ")
+        {
+          let length = line.utf16.distance(from: line.startIndex, to: space)
+          string.addAttribute(.foregroundColor, value: NSColor.systemPink, range: NSRange(location: 0, length: length))
+        }
+        return string
+      }
+
+    static let displayData = TextLine.DisplayData(maxWidth: 240, lineHeightMultiplier: 1.2, estimatedLineHeight: 14)
+
+    /// Typesets every line again with CoreText, as re-highlighting or scrolling back over a proportional font does.
+    func test_retypesetCachedPerformance()
+    {
+      let cache = TypesetCache(costLimit: 1 << 24)
+      typesetAll(cache: cache)
+      benchmark
+      {
+        typesetAll(cache: cache)
+      }
+    }
+
+    /// Baseline for ``test_retypesetCachedPerformance()``, typesetting every line with CoreText.
+    func test_retypesetUncachedPerformance()
+    {
+      benchmark
+      {
+        typesetAll(cache: nil)
+      }
+    }
+
+    private func typesetAll(cache: TypesetCache?)
+    {
+      let typesetter = Typesetter()
+      typesetter.allowsMonospaceLayout = false
+      var height: CGFloat = 0
+      for line in Self.lines
+      {
+        typesetter.typeset(
+          line,
+          displayData: Self.displayData,
+          breakStrategy: .word,
+          markedRanges: nil,
+          cache: cache
+        )
+        height += typesetter.lineFragments.height
+      }
+      XCTAssertGreaterThan(height, 0)
+    }
+  }
+#endif
@@ -0,0 +1,114 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+import Foundation
+import XCTest
+@testable import CodeViewCore
+
+final class WorkspaceSearchBenchmarks: BenchmarkTestCase
+{
+  /// A synthetic workspace of 10k files: usda layers, Swift plugin sources and binary crate files, spread over 100
+  /// directories. Created once and removed when the process exits.
+  static let root: URL =
+  {
+    let root = FileManager.default.temporaryDirectory
+      .appendingPathComponent("WorkspaceSearchBenchmarks-\(ProcessInfo.processInfo.processIdentifier)")
+    let usda = Corpus.usda(primCount: 4)
+    let swift = Corpus.swift(count: 4)
+    let crate = Data((0 ..< 4096).map { UInt8(truncatingIfNeeded: $0 &* 31) })
+    for directory in 0 ..< 100
+    {
+      let url = root.appendingPathComponent("plugin_\(directory)")
+      try? FileManager.default.createDirectory(at: url, withIntermediateDirectories: true)
+      for file in 0 ..< 100
+      {
+        switch file % 10
+        {
+          case 0:
+            try? crate.write(to: url.appendingPathComponent("layer_\(file).usdc"))
+          case 1 ... 5:
+            try? usda.write(to: url.appendingPathComponent("layer_\(file).usda"), atomically: false, encoding: .utf8)
+          default:
+            try? swift.write(to: url.appendingPathComponent("Source_\(file).swift"), atomically: false, encoding: .utf8)
+        }
+      }
+    }
+    atexit { try? FileManager.default.removeItem(at: WorkspaceSearchBenchmarks.root) }
+    return root
+  }()
+
+  static let options = WorkspaceSearch.Options(skippedExtensions: ["usd", "usdc", "usdz"])
+
+  /// Lists the workspace's searchable files.
+  func test_listFilesPerformance()
+  {
+    _ = Self.root
+    benchmark(iterations: 5)
+    {
+      XCTAssertEqual(WorkspaceSearch.files(in: [Self.root], options: Self.options).count, 9000)
+    }
+  }
+
+  /// Searches every file of the workspace for a literal.
+  func test_literalSearchPerformance()
+  {
+    let files = WorkspaceSearch.files(in: [Self.root], options: Self.options)
+    benchmark(iterations: 5)
+    {
+      var count = 0
+      let lock = NSLock()
+      WorkspaceSearch.search(files, for: TextSearchEngine.Query("radius"), options: Self.options)
+      { _ in
+        lock.lock()
+        count += 1
+        lock.unlock()
+      }
+      XCTAssertEqual(count, 5000)
+    }
+  }
+
+  /// Searches every file of the workspace for a regular expression.
+  func test_regularExpressionSearchPerformance()
+  {
+    let files = WorkspaceSearch.files(in: [Self.root], options: Self.options)
+    benchmark(iterations: 5)
+    {
+      var count = 0
+      let lock = NSLock()
+      WorkspaceSearch.search(
+        files,
+        for: TextSearchEngine.Query("radius = \\d+\\.\\d", mode: .regularExpression),
+        options: Self.options
+      )
+      { _ in
+        lock.lock()
+        count += 1
+        lock.unlock()
+      }
+      XCTAssertEqual(count, 5000)
+    }
+  }
+}
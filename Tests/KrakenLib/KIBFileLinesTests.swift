@@ -0,0 +1,116 @@
+/* --------------------------------------------------------------
+ * :: :  K  R  A  K  E  N  :                                   ::
+ * --------------------------------------------------------------
+ * @wabistudios :: metaverse :: kraken
+ *
+ * This program is free software; you can redistribute it, and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. Check out
+ * the GNU General Public License for more details.
+ *
+ * You should have received a copy for this software license, the
+ * GNU General Public License along with this program; or, if not
+ * write to the Free Software Foundation, Inc., to the address of
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *                            Copyright (C) 2023 Wabi Foundation.
+ *                                           All Rights Reserved.
+ * --------------------------------------------------------------
+ *  . x x x . o o o . x x x . : : : .    o  x  o    . : : : .
+ * -------------------------------------------------------------- */
+
+
+import Foundation
+import KrakenLib
+import XCTest
+
+final class KIBFileLinesTests: XCTestCase
+{
+  private var urls: [URL] = []
+
+  override func tearDown()
+  {
+    for url in urls
+    {
+      try? FileManager.default.removeItem(at: url)
+    }
+    urls = []
+    super.tearDown()
+  }
+
+  /// Writes `bytes` to a new temporary file, removed when the test ends.
+  private func file(_ bytes: [UInt8]) throws -> URL
+  {
+    let url = FileManager.default.temporaryDirectory.appendingPathComponent("KIBFileLinesTests-\(UUID()).txt")
+    try Data(bytes).write(to: url)
+    urls.append(url)
+    return url
+  }
+
+  private func file(_ text: String) throws -> URL
+  {
+    try file(Array(text.utf8))
+  }
+
+  func test_emptyFile() throws
+  {
+    let url = try file("")
+    XCTAssertEqual(try url.readFirstLines(3), "")
+    XCTAssertEqual(try url.readLastLines(3), "")
+  }
+
+  func test_fileShorterThanWindow() throws
+  {
+    let url = try file("one\ntwo\nthree")
+    XCTAssertEqual(try url.readFirstLines(1), "one")
+    XCTAssertEqual(try url.readFirstLines(2), "one\ntwo")
+    XCTAssertEqual(try url.readFirstLines(10), "one\ntwo\nthree")
+    XCTAssertEqual(try url.readLastLines(1), "three")
+    XCTAssertEqual(try url.readLastLines(2), "two\nthree")
+    XCTAssertEqual(try url.readLastLines(10), "one\ntwo\nthree")
+  }
+
+  func test_crlfLineBreaks() throws
+  {
+    let url = try file("one\r\ntwo\r\nthree")
+    XCTAssertEqual(try url.readFirstLines(1), "one")
+    XCTAssertEqual(try url.readFirstLines(2), "one\r\ntwo")
+    XCTAssertEqual(try url.readLastLines(1), "three")
+    XCTAssertEqual(try url.readLastLines(2), "two\r\nthree")
+
+    // the window starts between the carriage return and the line feed.
+    XCTAssertEqual(try url.readLastLines(2, maxBytes: 6), "\nthree")
+  }
+
+  func test_lastLinesDropCharacterSplitAtSeek() throws
+  {
+    // "ab\n€\nxyz", where the euro sign is the three bytes E2 82 AC at offsets 3 ..< 6.
+    let url = try file("ab\n€\nxyz")
+    XCTAssertEqual(try url.readLastLines(2, maxBytes: 7), "€\nxyz")
+    XCTAssertEqual(try url.readLastLines(2, maxBytes: 6), "\nxyz")
+    XCTAssertEqual(try url.readLastLines(2, maxBytes: 5), "\nxyz")
+    XCTAssertEqual(try url.readLastLines(1, maxBytes: 5), "xyz")
+  }
+
+  func test_firstLinesDropCharacterSplitAtWindow() throws
+  {
+    // "€€\nx", where the second euro sign is the bytes at offsets 3 ..< 6.
+    let url = try file("€€\nx")
+    XCTAssertEqual(try url.readFirstLines(1, maxBytes: 6), "€€")
+    XCTAssertEqual(try url.readFirstLines(1, maxBytes: 5), "€")
+    XCTAssertEqual(try url.readFirstLines(1, maxBytes: 4), "€")
+    XCTAssertEqual(try url.readFirstLines(1, maxBytes: 2), "")
+  }
+
+  func test_invalidBytesAreNotMistakenForASplit() throws
+  {
+    // a stray continuation byte in the middle of the window is kept as a replacement character.
+    let url = try file([0x61, 0x0A, 0x80, 0x62, 0x0A, 0x63])
+    XCTAssertEqual(try url.readLastLines(2), "\u{FFFD}b\nc")
+  }
+}